@@ -0,0 +1,262 @@
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compares two JSON files written by the benchmark suites' --json option,
+// typically from two builds:
+//
+//     bench_diff [--threshold PERCENT] before.json after.json
+//
+// For every benchmark in both files it prints the median time and, where
+// both runs had them, the median cycle and instruction counts, with the
+// change from before to after. With --threshold, exits with status 1 if
+// any median time grew by more than PERCENT.
+
+// Just enough JSON for the suites' output
+struct json {
+    enum kind_t { null, boolean, number, string, array, object };
+    kind_t kind = null;
+    bool flag = false;
+    double value = 0;
+    std::string text;
+    std::vector<json> items;
+    std::vector<std::pair<std::string, json>> members;
+
+    const json* find(const std::string& key) const {
+        for (const auto& [name, member] : members) {
+            if (name == key) {
+                return &member;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class json_parser {
+public:
+    explicit json_parser(std::string text) : text_(std::move(text)) {}
+
+    json parse() {
+        json v = parse_value();
+        skip_space();
+        if (pos_ != text_.size()) {
+            fail("trailing characters");
+        }
+        return v;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error{"JSON " + what + " at offset " + std::to_string(pos_)};
+    }
+
+    void skip_space() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail(std::string("expected '") + c + "'");
+        }
+    }
+
+    bool consume_word(const char* word) {
+        std::string_view w(word);
+        if (text_.compare(pos_, w.size(), w) == 0) {
+            pos_ += w.size();
+            return true;
+        }
+        return false;
+    }
+
+    json parse_value() {
+        skip_space();
+        json v;
+        if (pos_ == text_.size()) {
+            fail("unexpected end");
+        }
+        char c = text_[pos_];
+        if (c == '{') {
+            ++pos_;
+            v.kind = json::object;
+            if (!consume('}')) {
+                do {
+                    skip_space();
+                    std::string key = parse_string();
+                    expect(':');
+                    v.members.emplace_back(std::move(key), parse_value());
+                } while (consume(','));
+                expect('}');
+            }
+        } else if (c == '[') {
+            ++pos_;
+            v.kind = json::array;
+            if (!consume(']')) {
+                do {
+                    v.items.push_back(parse_value());
+                } while (consume(','));
+                expect(']');
+            }
+        } else if (c == '"') {
+            v.kind = json::string;
+            v.text = parse_string();
+        } else if (consume_word("null")) {
+            v.kind = json::null;
+        } else if (consume_word("true")) {
+            v.kind = json::boolean;
+            v.flag = true;
+        } else if (consume_word("false")) {
+            v.kind = json::boolean;
+        } else {
+            std::size_t used = 0;
+            try {
+                v.value = std::stod(text_.substr(pos_, 64), &used);
+            } catch (std::exception&) {
+                fail("bad value");
+            }
+            v.kind = json::number;
+            pos_ += used;
+        }
+        return v;
+    }
+
+    // Escapes other than \uXXXX are decoded; the suites only write \u for
+    // control characters, which are kept as the escape text
+    std::string parse_string() {
+        if (pos_ == text_.size() || text_[pos_] != '"') {
+            fail("expected string");
+        }
+        ++pos_;
+        std::string s;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            char c = text_[pos_++];
+            if (c == '\\' && pos_ < text_.size()) {
+                char e = text_[pos_++];
+                switch (e) {
+                case 'n': s += '\n'; break;
+                case 't': s += '\t'; break;
+                case 'u': s += "\\u"; break;
+                default: s += e;
+                }
+            } else {
+                s += c;
+            }
+        }
+        if (pos_ == text_.size()) {
+            fail("unterminated string");
+        }
+        ++pos_;
+        return s;
+    }
+
+    std::string text_;
+    std::size_t pos_ = 0;
+};
+
+json load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error{"cannot read " + path};
+    }
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return json_parser(contents.str()).parse();
+}
+
+// Median of one metric of a benchmark, or NaN if it was not measured
+double median(const json& benchmark, const std::string& metric) {
+    const json* m = benchmark.find(metric);
+    const json* med = m ? m->find("median") : nullptr;
+    return med && med->kind == json::number ? med->value : std::nan("");
+}
+
+std::string change(double before, double after) {
+    if (std::isnan(before) || std::isnan(after) || before == 0) {
+        return "";
+    }
+    std::ostringstream os;
+    os << std::showpos << std::fixed << std::setprecision(1) << (after / before - 1) * 100 << "%";
+    return os.str();
+}
+
+int main(int argc, char* argv[]) {
+    double threshold = std::nan("");
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threshold" && i + 1 < argc) {
+            threshold = std::stod(argv[++i]);
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != 2) {
+        std::cerr << "usage: bench_diff [--threshold PERCENT] before.json after.json" << std::endl;
+        return 2;
+    }
+
+    json before, after;
+    try {
+        before = load(files[0]);
+        after = load(files[1]);
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    std::map<std::string, const json*> old_results;
+    if (const json* list = before.find("benchmarks")) {
+        for (const json& b : list->items) {
+            if (const json* name = b.find("name")) {
+                old_results[name->text] = &b;
+            }
+        }
+    }
+
+    std::cout << std::left << std::setw(48) << "benchmark" << std::right << std::setw(12) << "before ms"
+              << std::setw(12) << "after ms" << std::setw(10) << "time" << std::setw(10) << "cycles"
+              << std::setw(10) << "instr" << std::endl;
+    bool regressed = false;
+    const json* list = after.find("benchmarks");
+    if (!list) {
+        return 0;
+    }
+    for (const json& b : list->items) {
+        const json* name = b.find("name");
+        if (!name || !old_results.count(name->text)) {
+            continue;
+        }
+        const json& old = *old_results[name->text];
+        double old_time = median(old, "time_ns");
+        double new_time = median(b, "time_ns");
+        std::cout << std::left << std::setw(48) << name->text << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(12) << old_time / 1e6 << std::setw(12)
+                  << new_time / 1e6 << std::setw(10) << change(old_time, new_time) << std::setw(10)
+                  << change(median(old, "cycles"), median(b, "cycles")) << std::setw(10)
+                  << change(median(old, "instructions"), median(b, "instructions")) << std::endl;
+        if (!std::isnan(threshold) && new_time > old_time * (1 + threshold / 100)) {
+            regressed = true;
+        }
+    }
+    return regressed ? 1 : 0;
+}
@@ -0,0 +1,432 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Shared harness for the benchmark suites in this directory. A suite
+// runs each case a few times untimed to warm caches, branch predictors and
+// the allocator, then times it for a number of trials, and reports the
+// minimum, median, mean, standard deviation and maximum of every trial's
+// wall-clock time and hardware counters (cycles, instructions, cache
+// misses, branch misses, read with perf_event_open). The process is
+// pinned to one CPU, so trials do not migrate between cores.
+//
+//     bench::suite suite("sorting", argc, argv);
+//     suite.run("std::sort vector<int>", data.size(),
+//               [&] { work = data; },                        // untimed setup
+//               [&] { std::sort(work.begin(), work.end()); });
+//     return suite.finish();
+//
+// Every suite takes the same options:
+//
+//     --warmup N     untimed runs before the trials (default 2)
+//     --trials N     timed runs (default 10)
+//     --cpu N        CPU to pin to; -1 leaves the process unpinned
+//                    (default: the CPU the suite starts on)
+//     --filter TEXT  run only cases whose name contains TEXT
+//     --json FILE    also write the results to FILE, for bench_diff
+//     --no-counters  time only
+//
+// Counters count the calling thread only, in user mode, so threads and
+// processes a case starts are timed but not counted. Counters the kernel
+// or the machine does not provide (virtual machines often have none, and
+// perf_event_paranoid may forbid them) are reported as unavailable and
+// written to the JSON as null.
+
+namespace bench {
+
+// Keeps the compiler from discarding a result nobody reads
+template<typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct options {
+    std::size_t warmup = 2;
+    std::size_t trials = 10;
+    int cpu = -2; // -2: wherever the suite starts, -1: unpinned
+    std::string filter;
+    std::string json;
+    bool counters = true;
+
+    static options parse(int argc, char* argv[]) {
+        options opts;
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 == argc) {
+                    throw std::invalid_argument{std::string(arg) + " needs a value"};
+                }
+                return argv[++i];
+            };
+            if (arg == "--warmup") {
+                opts.warmup = std::stoul(value());
+            } else if (arg == "--trials") {
+                opts.trials = std::stoul(value());
+            } else if (arg == "--cpu") {
+                opts.cpu = std::stoi(value());
+            } else if (arg == "--filter") {
+                opts.filter = value();
+            } else if (arg == "--json") {
+                opts.json = value();
+            } else if (arg == "--no-counters") {
+                opts.counters = false;
+            } else {
+                throw std::invalid_argument{"unknown option " + std::string(arg)};
+            }
+        }
+        if (opts.trials == 0) {
+            throw std::invalid_argument{"--trials must be at least 1"};
+        }
+        return opts;
+    }
+};
+
+struct summary {
+    double min;
+    double median;
+    double mean;
+    double stddev;
+    double max;
+};
+
+inline summary summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    std::size_t n = samples.size();
+    double mean = 0;
+    for (double s : samples) {
+        mean += s;
+    }
+    mean /= static_cast<double>(n);
+    double squares = 0;
+    for (double s : samples) {
+        squares += (s - mean) * (s - mean);
+    }
+    double median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    double stddev = n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0;
+    return {samples.front(), median, mean, stddev, samples.back()};
+}
+
+// The four hardware counters, opened as one perf event group so they are
+// scheduled onto the PMU together and read with a single read()
+class counters {
+public:
+    static constexpr std::size_t count = 4;
+    static constexpr std::array<const char*, count> names
+        = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+    counters() {
+        constexpr std::array<std::uint64_t, count> configs
+            = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+               PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (std::size_t i = 0; i < count; ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = leader_ < 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                               | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            // The first counter that opens leads the group
+            long fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0);
+            if (fd < 0) {
+                if (error_.empty()) {
+                    error_ = std::string(names[i]) + ": " + std::strerror(errno);
+                }
+                continue;
+            }
+            fds_[i] = static_cast<int>(fd);
+            slot_[i] = opened_++;
+            if (leader_ < 0) {
+                leader_ = fds_[i];
+            }
+        }
+    }
+
+    counters(const counters&) = delete;
+    counters& operator=(const counters&) = delete;
+
+    ~counters() {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    bool available(std::size_t i) const { return fds_[i] >= 0; }
+    bool any() const { return leader_ >= 0; }
+
+    // Why the first unavailable counter could not be opened
+    const std::string& error() const { return error_; }
+
+    void start() {
+        if (any()) {
+            ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    // Counts since start(), scaled up if the kernel had to multiplex the
+    // group with other events for part of the time
+    std::array<std::optional<double>, count> stop() {
+        std::array<std::optional<double>, count> values;
+        if (!any()) {
+            return values;
+        }
+        ::ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        std::array<std::uint64_t, 3 + count> buffer{};
+        if (::read(leader_, buffer.data(), sizeof(buffer)) < 0) {
+            return values;
+        }
+        // nr, time_enabled, time_running, then one value per open counter
+        double scale = buffer[2] ? static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]) : 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (available(i) && scale != 0) {
+                values[i] = static_cast<double>(buffer[3 + slot_[i]]) * scale;
+            }
+        }
+        return values;
+    }
+
+private:
+    std::array<int, count> fds_ = {-1, -1, -1, -1};
+    std::array<std::size_t, count> slot_{};
+    std::size_t opened_ = 0;
+    int leader_ = -1;
+    std::string error_;
+};
+
+struct result {
+    std::string name;
+    std::size_t items;
+    summary time_ns;
+    std::array<std::optional<summary>, counters::count> counts;
+};
+
+inline void write_json_string(std::ostream& os, std::string_view s) {
+    os << '"';
+    for (char c : s) {
+        switch (c) {
+        case '"': os << "\\\""; break;
+        case '\\': os << "\\\\"; break;
+        case '\n': os << "\\n"; break;
+        case '\t': os << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c)
+                   << std::dec << std::setfill(' ');
+            } else {
+                os << c;
+            }
+        }
+    }
+    os << '"';
+}
+
+inline void write_json_summary(std::ostream& os, const summary& s) {
+    os << "{\"min\": " << s.min << ", \"median\": " << s.median << ", \"mean\": " << s.mean
+       << ", \"stddev\": " << s.stddev << ", \"max\": " << s.max << "}";
+}
+
+class suite {
+public:
+    suite(std::string name, int argc, char* argv[])
+        : name_(std::move(name)), opts_(options::parse(argc, argv)) {
+        if (opts_.cpu == -2) {
+            opts_.cpu = ::sched_getcpu();
+        }
+        if (opts_.cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(opts_.cpu, &set);
+            if (::sched_setaffinity(0, sizeof(set), &set) != 0) {
+                std::cerr << "warning: cannot pin to CPU " << opts_.cpu << ": "
+                          << std::strerror(errno) << std::endl;
+                opts_.cpu = -1;
+            }
+        }
+        if (opts_.counters) {
+            counters_.emplace();
+        }
+
+        std::cout << name_ << ": " << opts_.warmup << " warmup runs, " << opts_.trials << " trials, ";
+        if (opts_.cpu >= 0) {
+            std::cout << "pinned to CPU " << opts_.cpu << std::endl;
+        } else {
+            std::cout << "unpinned" << std::endl;
+        }
+        if (counters_ && !counters_->error().empty()) {
+            std::cout << "hardware counters unavailable (" << counters_->error() << ")" << std::endl;
+        }
+    }
+
+    suite(const suite&) = delete;
+    suite& operator=(const suite&) = delete;
+
+    // Times body, which handles items items (elements sorted, products
+    // created...) per run; per-item figures are printed for those. setup
+    // runs untimed before every run of body. Returns false if the case
+    // was filtered out and never ran.
+    template<typename Setup, typename Body>
+    bool run(const std::string& name, std::size_t items, Setup setup, Body body) {
+        if (name.find(opts_.filter) == std::string::npos) {
+            return false;
+        }
+        for (std::size_t i = 0; i < opts_.warmup; ++i) {
+            setup();
+            body();
+        }
+
+        std::vector<double> times;
+        std::array<std::vector<double>, counters::count> counts;
+        for (std::size_t i = 0; i < opts_.trials; ++i) {
+            setup();
+            if (counters_) {
+                counters_->start();
+            }
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto end = std::chrono::steady_clock::now();
+            if (counters_) {
+                auto values = counters_->stop();
+                for (std::size_t c = 0; c < counters::count; ++c) {
+                    if (values[c]) {
+                        counts[c].push_back(*values[c]);
+                    }
+                }
+            }
+            times.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+
+        result r{name, items, summarize(times), {}};
+        for (std::size_t c = 0; c < counters::count; ++c) {
+            // A counter that failed to read on some trial is left out
+            if (counts[c].size() == opts_.trials) {
+                r.counts[c] = summarize(counts[c]);
+            }
+        }
+        print(r);
+        results_.push_back(std::move(r));
+        return true;
+    }
+
+    template<typename Body>
+    bool run(const std::string& name, std::size_t items, Body body) {
+        return run(name, items, [] {}, body);
+    }
+
+    // Writes the JSON file if one was asked for; returns main's exit status
+    int finish() const {
+        if (opts_.json.empty()) {
+            return 0;
+        }
+        std::ofstream out(opts_.json);
+        write_json(out);
+        if (!out) {
+            std::cerr << "cannot write " << opts_.json << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    const std::vector<result>& results() const { return results_; }
+
+private:
+    void print(const result& r) const {
+        const auto items = static_cast<double>(std::max<std::size_t>(r.items, 1));
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3) << "  " << std::left << std::setw(48) << r.name
+             << std::right << std::setw(11) << r.time_ns.median / 1e6 << " ms";
+        double spread = r.time_ns.median > 0 ? r.time_ns.stddev / r.time_ns.median * 100 : 0;
+        line << std::setprecision(1) << " ±" << std::setw(4) << spread << "%";
+        line << std::setprecision(2) << std::setw(10) << r.time_ns.median / items << " ns/item";
+        const auto& cycles = r.counts[0];
+        const auto& instructions = r.counts[1];
+        if (cycles) {
+            line << std::setw(9) << cycles->median / items << " cyc/item";
+        }
+        if (cycles && instructions && cycles->median > 0) {
+            line << "  IPC " << instructions->median / cycles->median;
+        }
+        if (r.counts[2]) {
+            line << std::setprecision(4) << "  cache-miss/item " << r.counts[2]->median / items;
+        }
+        if (r.counts[3]) {
+            line << std::setprecision(4) << "  branch-miss/item " << r.counts[3]->median / items;
+        }
+        std::cout << line.str() << std::endl;
+    }
+
+    // One benchmark per line, in run order, so two files from different
+    // builds diff line by line
+    void write_json(std::ostream& os) const {
+        os << std::setprecision(10);
+        os << "{\n  \"suite\": ";
+        write_json_string(os, name_);
+        os << ",\n  \"context\": {\"compiler\": ";
+        write_json_string(os, __VERSION__);
+        os << ", \"build\": ";
+#ifdef BENCH_BUILD_TYPE
+        write_json_string(os, BENCH_BUILD_TYPE);
+#else
+        write_json_string(os, "");
+#endif
+        os << ", \"cpu\": " << opts_.cpu << ", \"warmup\": " << opts_.warmup
+           << ", \"trials\": " << opts_.trials << ", \"counter_error\": ";
+        if (counters_ && counters_->error().empty()) {
+            os << "null";
+        } else {
+            write_json_string(os, counters_ ? counters_->error() : "disabled");
+        }
+        os << "},\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            const result& r = results_[i];
+            os << (i ? ",\n" : "\n") << "    {\"name\": ";
+            write_json_string(os, r.name);
+            os << ", \"items\": " << r.items << ", \"time_ns\": ";
+            write_json_summary(os, r.time_ns);
+            for (std::size_t c = 0; c < counters::count; ++c) {
+                os << ", \"" << counters::names[c] << "\": ";
+                if (r.counts[c]) {
+                    write_json_summary(os, *r.counts[c]);
+                } else {
+                    os << "null";
+                }
+            }
+            os << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    std::string name_;
+    options opts_;
+    std::optional<counters> counters_;
+    std::vector<result> results_;
+};
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,117 @@
+#include "benchmark.h"
+#include "flexible_factory.h"
+#include "prototype_factory.h"
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace cspp51045;
+
+// Factory creation suite: a train's worth of freight cars and couplers
+// made through each of the flexible factory's creation modes. create<>()
+// goes through the virtual creator and the global heap, the flat factory
+// through its creator table, the thread-cached factory through the
+// creating thread's block cache, and the prototype factory copies a
+// configured prototype, one at a time or all into one block. Destroying
+// the products is not timed.
+
+constexpr std::size_t products = 200000;
+
+struct FreightCar {
+    virtual long getCapacity() const = 0;
+    virtual ~FreightCar() = default;
+};
+
+class RealFreightCar : public FreightCar {
+    long capacity;
+public:
+    RealFreightCar(long cap) : capacity(cap) {}
+    long getCapacity() const override { return capacity; }
+};
+
+// Trivially copyable, so clone_n copies it as bytes
+struct Coupler {
+    double strength;
+    double workingLoad;
+    double proofLoad;
+
+    Coupler(double s) : strength(s), workingLoad(s / 2.5), proofLoad(s / 1.25) {}
+};
+
+using CarFactory = flexible_abstract_factory<FreightCar(long), Coupler(double)>;
+using RealCarFactory = flexible_concrete_factory<CarFactory, RealFreightCar, Coupler>;
+// Thread-cached products need a virtual destructor, which Coupler lacks
+using FreightCarFactory = flexible_abstract_factory<FreightCar(long)>;
+using CachedFreightCarFactory = thread_cached_flexible_factory<FreightCarFactory, RealFreightCar>;
+using PrototypeCarFactory = flexible_prototype_factory<CarFactory, RealFreightCar, Coupler>;
+
+using FlatCarFactory = flat_flexible_abstract_factory<FreightCar(long), Coupler(double)>;
+using FlatRealCarFactory = flat_flexible_concrete_factory<FlatCarFactory, RealFreightCar, Coupler>;
+
+void check(std::size_t made, const std::string& name) {
+    if (made != products) {
+        std::cerr << name << ": made " << made << " products" << std::endl;
+        std::exit(1);
+    }
+}
+
+// Times making products one at a time with make(), into a vector
+template<typename Product, typename Make>
+void create_case(bench::suite& suite, const std::string& name, Make make) {
+    std::vector<std::unique_ptr<Product>> made;
+    bool ran = suite.run(name, products,
+                         [&] { made.clear(); made.reserve(products); },
+                         [&] {
+                             for (std::size_t i = 0; i < products; ++i) {
+                                 made.push_back(make());
+                             }
+                         });
+    if (ran) {
+        check(made.size(), name);
+    }
+}
+
+template<typename Product>
+void clone_n_case(bench::suite& suite, const std::string& name, PrototypeCarFactory& factory) {
+    std::optional<pooled_products<Product>> made;
+    bool ran = suite.run(name, products,
+                         [&] { made.reset(); },
+                         [&] { made.emplace(factory.clone_n<Product>(products)); });
+    if (ran) {
+        check(made->size(), name);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bench::suite suite("factory creation", argc, argv);
+
+    RealCarFactory real;
+    CachedFreightCarFactory cached;
+    FlatRealCarFactory flat;
+    PrototypeCarFactory prototypes(RealFreightCar(50000L), Coupler(1200.0));
+    CarFactory& abstract = real;
+    FreightCarFactory& abstractCached = cached;
+    FlatCarFactory& abstractFlat = flat;
+
+    create_case<FreightCar>(suite, "create<FreightCar>",
+                            [&] { return abstract.create<FreightCar>(50000L); });
+    create_case<FreightCar>(suite, "flat create<FreightCar>",
+                            [&] { return abstractFlat.create<FreightCar>(50000L); });
+    create_case<FreightCar>(suite, "thread-cached create<FreightCar>",
+                            [&] { return abstractCached.create<FreightCar>(50000L); });
+    create_case<FreightCar>(suite, "prototype clone<FreightCar>",
+                            [&] { return prototypes.clone<FreightCar>(); });
+    clone_n_case<FreightCar>(suite, "prototype clone_n<FreightCar>", prototypes);
+
+    create_case<Coupler>(suite, "create<Coupler>",
+                         [&] { return abstract.create<Coupler>(1200.0); });
+    create_case<Coupler>(suite, "flat create<Coupler>",
+                         [&] { return abstractFlat.create<Coupler>(1200.0); });
+    create_case<Coupler>(suite, "prototype clone<Coupler>",
+                         [&] { return prototypes.clone<Coupler>(); });
+    clone_n_case<Coupler>(suite, "prototype clone_n<Coupler>", prototypes);
+
+    return suite.finish();
+}
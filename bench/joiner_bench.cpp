@@ -0,0 +1,102 @@
+#include "benchmark.h"
+#include "ostream_joiner.h"
+#include "sink_joiner.h"
+#include <cstdlib>
+#include <fstream>
+#include <locale>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Joiner formatting suite: a million ints, doubles and wide strings
+// joined with ", " by each joiner. Stream joiners write to /dev/null; the
+// span joiner formats into a preallocated buffer. Each joiner's output is
+// checked against ostream_joiner's once, outside the timed runs.
+
+constexpr std::size_t elements = 1000000;
+
+template<typename T, typename Write>
+void stream_case(bench::suite& suite, const std::string& name, const std::vector<T>& data,
+                 const std::string& expected, Write write) {
+    std::ofstream sink("/dev/null");
+    if (!suite.run(name, data.size(), [&] { write(sink, data); })) {
+        return;
+    }
+    std::ostringstream os;
+    write(os, data);
+    if (os.str() != expected) {
+        std::cerr << name << ": output differs" << std::endl;
+        std::exit(1);
+    }
+}
+
+template<typename T>
+void joiner_cases(bench::suite& suite, const std::string& type, const std::vector<T>& data) {
+    std::ostringstream plain;
+    std::copy(data.begin(), data.end(), ostream_joiner(plain, ", "));
+    const std::string expected = plain.str();
+
+    stream_case(suite, "ostream_joiner " + type, data, expected, [](std::ostream& os, const auto& v) {
+        std::copy(v.begin(), v.end(), ostream_joiner(os, ", "));
+    });
+    stream_case(suite, "buffered_ostream_joiner " + type, data, expected, [](std::ostream& os, const auto& v) {
+        std::copy(v.begin(), v.end(), buffered_ostream_joiner(os, ", "));
+    });
+#ifdef JOINER_HAS_FORMAT
+    stream_case(suite, "format_joiner " + type, data, expected, [](std::ostream& os, const auto& v) {
+        if constexpr (std::is_floating_point_v<T>) {
+            std::copy(v.begin(), v.end(), format_joiner<T>(os, ", ", "{:.6g}"));
+        } else {
+            std::copy(v.begin(), v.end(), format_joiner<T>(os, ", "));
+        }
+    });
+#endif
+
+    std::vector<char> out(expected.size() + 1024);
+    std::size_t written = 0;
+    bool ran = suite.run("span_joiner " + type, data.size(), [&] {
+        span_joiner joiner(out, ", ");
+        std::copy(data.begin(), data.end(), joiner);
+        written = joiner.size();
+    });
+    if (ran && std::string_view(out.data(), written) != expected) {
+        std::cerr << "span_joiner " << type << ": output differs" << std::endl;
+        std::exit(1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bench::suite suite("joiner formatting", argc, argv);
+
+    std::mt19937 gen(42);
+    std::vector<int> ints(elements);
+    std::vector<double> doubles(elements);
+    for (std::size_t i = 0; i < elements; ++i) {
+        ints[i] = static_cast<int>(gen());
+        doubles[i] = static_cast<double>(gen()) / 1000.0;
+    }
+    joiner_cases(suite, "vector<int>", ints);
+    joiner_cases(suite, "vector<double>", doubles);
+
+    const wchar_t* words[] = {L"matcha", L"hōjicha", L"genmaicha", L"café au lait",
+                              L"東京", L"rooibos"};
+    std::vector<std::wstring> wide(elements);
+    for (std::size_t i = 0; i < elements; ++i) {
+        wide[i] = words[i % 6] + std::wstring(L" #") + std::to_wstring(i);
+    }
+    std::ostringstream transcoded;
+    std::copy(wide.begin(), wide.end(), buffered_ostream_joiner(transcoded, L", "));
+
+    std::wofstream wide_sink("/dev/null");
+    wide_sink.imbue(std::locale("C.UTF-8"));
+    suite.run("wide stream codecvt vector<wstring>", elements, [&] {
+        std::copy(wide.begin(), wide.end(), buffered_ostream_joiner(wide_sink, L", "));
+    });
+    stream_case(suite, "buffered_ostream_joiner to_utf8 vector<wstring>", wide, transcoded.str(),
+                [](std::ostream& os, const auto& v) {
+                    std::copy(v.begin(), v.end(), buffered_ostream_joiner(os, L", "));
+                });
+
+    return suite.finish();
+}
@@ -0,0 +1,161 @@
+#include "benchmark.h"
+#include "my_promoise.h"
+#include "shm_promise.h"
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace mpcs;
+
+// Promise handoff suite. Same-thread cases measure the cost of the shared
+// state alone: set a value or an error, then read it back. Ping-pong cases
+// hand a value to a worker thread and wait for its reply, so every item
+// is two handoffs and (with the suite pinned to one CPU) two context
+// switches. The last case forks a worker process per item and collects
+// its result through a ShmPromise. Only the benchmarking thread is
+// counted, not its workers.
+
+constexpr std::size_t local_items = 200000;
+constexpr std::size_t pingpong_items = 20000;
+constexpr std::size_t fork_items = 50;
+
+enum class ErrorCode { overloaded };
+
+// Checks a case's result, if the case ran
+void expect(bool ran, long long got, long long want, const std::string& name) {
+    if (ran && got != want) {
+        std::cerr << name << ": got " << got << ", expected " << want << std::endl;
+        std::exit(1);
+    }
+}
+
+// The worker answers request i with i + 1
+template<typename Promises, typename Futures>
+long long pingpong(Promises& requests, Futures& requestFutures, Promises& replies, Futures& replyFutures) {
+    std::size_t n = requests.size();
+    std::thread worker([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            replies[i].set_value(requestFutures[i].get() + 1);
+        }
+    });
+    long long sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        requests[i].set_value(static_cast<int>(i));
+        sum += replyFutures[i].get();
+    }
+    worker.join();
+    return sum;
+}
+
+int main(int argc, char* argv[]) {
+    bench::suite suite("promise handoff", argc, argv);
+    const auto n = static_cast<long long>(local_items);
+
+    long long sum = 0;
+    bool ran = suite.run("MyPromise set_value + get", local_items, [&] {
+        sum = 0;
+        for (std::size_t i = 0; i < local_items; ++i) {
+            MyPromise<int> promise;
+            auto future = promise.get_future();
+            promise.set_value(1);
+            sum += future.get();
+        }
+    });
+    expect(ran, sum, n, "MyPromise set_value + get");
+
+    ran = suite.run("MyPromise set_error + try_get", local_items, [&] {
+        sum = 0;
+        for (std::size_t i = 0; i < local_items; ++i) {
+            MyPromise<int, ErrorCode> promise;
+            auto future = promise.get_future();
+            promise.set_error(ErrorCode::overloaded);
+            sum += !future.try_get();
+        }
+    });
+    expect(ran, sum, n, "MyPromise set_error + try_get");
+
+    // Exceptions are far slower; a tenth of the items
+    ran = suite.run("MyPromise set_exception + get", local_items / 10, [&] {
+        sum = 0;
+        for (std::size_t i = 0; i < local_items / 10; ++i) {
+            MyPromise<int> promise;
+            auto future = promise.get_future();
+            promise.set_exception(std::make_exception_ptr(std::runtime_error("overloaded")));
+            try {
+                future.get();
+            } catch (std::runtime_error&) {
+                ++sum;
+            }
+        }
+    });
+    expect(ran, sum, n / 10, "MyPromise set_exception + get");
+
+    {
+        std::vector<MyPromise<int>> requests, replies;
+        std::vector<MyFuture<int>> requestFutures, replyFutures;
+        ran = suite.run("MyPromise thread ping-pong", pingpong_items,
+                        [&] {
+                            requests.clear();
+                            replies.clear();
+                            requestFutures.clear();
+                            replyFutures.clear();
+                            for (std::size_t i = 0; i < pingpong_items; ++i) {
+                                requestFutures.push_back(requests.emplace_back().get_future());
+                                replyFutures.push_back(replies.emplace_back().get_future());
+                            }
+                        },
+                        [&] { sum = pingpong(requests, requestFutures, replies, replyFutures); });
+        auto m = static_cast<long long>(pingpong_items);
+        expect(ran, sum, m * (m + 1) / 2, "MyPromise thread ping-pong");
+    }
+
+    // Segments are made in the untimed setup, so only the handoff is timed
+    {
+        const std::string prefix = "/promise_bench." + std::to_string(::getpid()) + ".";
+        constexpr std::size_t items = pingpong_items / 10;
+        std::vector<ShmPromise<int>> requests, replies;
+        std::vector<ShmFuture<int>> requestFutures, replyFutures;
+        ran = suite.run("ShmPromise thread ping-pong", items,
+                        [&] {
+                            requests.clear();
+                            replies.clear();
+                            requestFutures.clear();
+                            replyFutures.clear();
+                            for (std::size_t i = 0; i < items; ++i) {
+                                requests.push_back(ShmPromise<int>::create(prefix + "request"));
+                                requestFutures.push_back(ShmFuture<int>::open(prefix + "request"));
+                                replies.push_back(ShmPromise<int>::create(prefix + "reply"));
+                                replyFutures.push_back(ShmFuture<int>::open(prefix + "reply"));
+                            }
+                        },
+                        [&] { sum = pingpong(requests, requestFutures, replies, replyFutures); });
+        auto m = static_cast<long long>(items);
+        expect(ran, sum, m * (m + 1) / 2, "ShmPromise thread ping-pong");
+    }
+
+    const std::string name = "/promise_bench." + std::to_string(::getpid());
+    ran = suite.run("ShmPromise fork + get", fork_items, [&] {
+        sum = 0;
+        for (std::size_t i = 0; i < fork_items; ++i) {
+            auto promise = ShmPromise<int>::create(name);
+            auto future = ShmFuture<int>::open(name); // and removes the name
+            pid_t pid = ::fork();
+            if (pid < 0) {
+                throw std::system_error{errno, std::generic_category(), "fork"};
+            }
+            if (pid == 0) {
+                promise.set_value(1);
+                ::_exit(0);
+            }
+            sum += future.get();
+            ::waitpid(pid, nullptr, 0);
+        }
+    });
+    expect(ran, sum, static_cast<long long>(fork_items), "ShmPromise fork + get");
+
+    return suite.finish();
+}
@@ -0,0 +1,102 @@
+#include "benchmark.h"
+#include "sort.h"
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+// Sorting suite: unified_sort against the standard library on random,
+// sorted, nearly sorted and few-distinct-value data, for each container unified_sort has
+// its own path for (radix for contiguous numbers, block-wise for deque,
+// pdq_sort for other random-access ranges, merge sort for lists).
+
+constexpr std::size_t vector_size = 1000000;
+constexpr std::size_t list_size = 100000;
+
+template<typename Container, typename Sort>
+void sort_case(bench::suite& suite, const std::string& name, const Container& data, Sort sort) {
+    Container work;
+    bool ran = suite.run(name, data.size(),
+                         [&] { work = data; },
+                         [&] { sort(work); });
+    if (ran && !std::is_sorted(work.begin(), work.end())) {
+        std::cerr << name << ": not sorted" << std::endl;
+        std::exit(1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bench::suite suite("sorting", argc, argv);
+
+    std::mt19937 gen(42);
+    std::vector<int> random_ints(vector_size);
+    for (int& v : random_ints) {
+        v = static_cast<int>(gen());
+    }
+    std::vector<int> sorted_ints(random_ints);
+    std::sort(sorted_ints.begin(), sorted_ints.end());
+    // Sorted with one element in a thousand swapped
+    std::vector<int> nearly_sorted_ints(sorted_ints);
+    for (std::size_t i = 0; i < vector_size / 1000; ++i) {
+        std::swap(nearly_sorted_ints[gen() % vector_size], nearly_sorted_ints[gen() % vector_size]);
+    }
+    std::vector<int> few_ints(vector_size);
+    for (int& v : few_ints) {
+        v = static_cast<int>(gen() % 16);
+    }
+    std::vector<double> random_doubles(vector_size);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    for (double& v : random_doubles) {
+        v = real(gen);
+    }
+    std::vector<double> sorted_doubles(random_doubles);
+    std::sort(sorted_doubles.begin(), sorted_doubles.end());
+    std::vector<long> sorted_longs(vector_size);
+    for (long& v : sorted_longs) {
+        v = static_cast<long>(gen()) << 16;
+    }
+    std::sort(sorted_longs.begin(), sorted_longs.end());
+    std::vector<std::string> random_strings(list_size);
+    for (auto& s : random_strings) {
+        s = "car-" + std::to_string(gen() % 1000000);
+    }
+
+    auto std_sort = [](auto& c) { std::sort(c.begin(), c.end()); };
+    auto std_stable_sort = [](auto& c) { std::stable_sort(c.begin(), c.end()); };
+    auto unified = [](auto& c) { unified_sort(c.begin(), c.end()); };
+    auto pdq = [](auto& c) { pdq_sort(c.begin(), c.end()); };
+
+    sort_case(suite, "std::sort vector<int> random", random_ints, std_sort);
+    sort_case(suite, "unified_sort vector<int> random", random_ints, unified);
+    sort_case(suite, "pdq_sort vector<int> random", random_ints, pdq);
+    sort_case(suite, "std::sort vector<int> sorted", sorted_ints, std_sort);
+    sort_case(suite, "unified_sort vector<int> sorted", sorted_ints, unified);
+    sort_case(suite, "std::sort vector<int> nearly sorted", nearly_sorted_ints, std_sort);
+    sort_case(suite, "unified_sort vector<int> nearly sorted", nearly_sorted_ints, unified);
+    sort_case(suite, "std::sort vector<int> 16 values", few_ints, std_sort);
+    sort_case(suite, "unified_sort vector<int> 16 values", few_ints, unified);
+    sort_case(suite, "pdq_sort vector<int> 16 values", few_ints, pdq);
+    sort_case(suite, "std::sort vector<double> random", random_doubles, std_sort);
+    sort_case(suite, "unified_sort vector<double> random", random_doubles, unified);
+    sort_case(suite, "std::sort vector<double> sorted", sorted_doubles, std_sort);
+    sort_case(suite, "unified_sort vector<double> sorted", sorted_doubles, unified);
+    sort_case(suite, "std::sort vector<long> sorted", sorted_longs, std_sort);
+    sort_case(suite, "unified_sort vector<long> sorted", sorted_longs, unified);
+    sort_case(suite, "std::sort vector<string> random", random_strings, std_sort);
+    sort_case(suite, "unified_sort vector<string> random", random_strings, unified);
+
+    std::deque<int> random_deque(random_ints.begin(), random_ints.end());
+    sort_case(suite, "std::sort deque<int> random", random_deque, std_sort);
+    sort_case(suite, "unified_sort deque<int> random", random_deque, unified);
+
+    std::list<int> random_list(random_ints.begin(), random_ints.begin() + list_size);
+    sort_case(suite, "list::sort list<int> random", random_list, [](auto& c) { c.sort(); });
+    sort_case(suite, "unified_sort list<int> random", random_list, unified);
+    std::vector<int> list_prefix(random_ints.begin(), random_ints.begin() + list_size);
+    sort_case(suite, "std::stable_sort vector<int> (list size)", list_prefix, std_stable_sort);
+
+    return suite.finish();
+}
@@ -0,0 +1,95 @@
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+// One translation unit that strips and counts CHAIN_TYPES pointer chains
+// of CHAIN_DEPTH layers each, entirely at compile time, using either
+// traits.h (NAIVE_TRAITS=0) or the original one-layer-per-instantiation
+// remove_all_pointers (NAIVE_TRAITS=1). pointerChainBenchmark compiles it
+// for several depths and compares compile times.
+
+#ifndef CHAIN_DEPTH
+#define CHAIN_DEPTH 100
+#endif
+
+#ifndef CHAIN_TYPES
+#define CHAIN_TYPES 100
+#endif
+
+#ifndef NAIVE_TRAITS
+#define NAIVE_TRAITS 0
+#endif
+
+namespace naive {
+
+template<class T>
+struct remove_all_pointers {
+    using type = T;
+};
+
+template<class T>
+struct remove_all_pointers<T*> {
+    using type = typename remove_all_pointers<T>::type;
+};
+
+template<class T>
+struct pointer_depth {
+    static constexpr std::size_t value = 0;
+};
+
+template<class T>
+struct pointer_depth<T*> {
+    static constexpr std::size_t value = 1 + pointer_depth<T>::value;
+};
+
+} // namespace naive
+
+#if NAIVE_TRAITS
+using naive::remove_all_pointers;
+using naive::pointer_depth;
+#else
+#include "traits.h"
+#endif
+
+// Builds T with N pointers added, eight at a time so that building the
+// chain itself stays shallow
+template<class T, std::size_t N, bool = (N >= 8)>
+struct add_pointers {
+    using type = typename add_pointers<T*, N - 1>::type;
+};
+
+template<class T>
+struct add_pointers<T, 0, false> {
+    using type = T;
+};
+
+template<class T, std::size_t N>
+struct add_pointers<T, N, true> {
+    using type = typename add_pointers<T********, N - 8>::type;
+};
+
+template<std::size_t I>
+struct Tag {
+};
+
+template<std::size_t I>
+constexpr bool checkChain() {
+    using chain = typename add_pointers<Tag<I>, CHAIN_DEPTH>::type;
+    return std::is_same_v<typename remove_all_pointers<chain>::type, Tag<I>>
+           && pointer_depth<chain>::value == CHAIN_DEPTH;
+}
+
+template<std::size_t... Is>
+constexpr bool checkChains(std::index_sequence<Is...>) {
+    return (checkChain<Is>() && ...);
+}
+
+static_assert(checkChains(std::make_index_sequence<CHAIN_TYPES>{}),
+              "every chain strips back to its tag");
+
+int main() {
+    std::cout << (NAIVE_TRAITS ? "naive" : "traits.h") << ": " << CHAIN_TYPES
+              << " chains of depth " << CHAIN_DEPTH << " checked at compile time" << std::endl;
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Compile-time benchmark for traits.h: compiles pointerChain.cpp (syntax
+// check only, so only template work is timed) for pointer chains of
+// several depths, with the naive one-layer-per-instantiation traits and
+// with traits.h. Each configuration is compiled twice: with the
+// compiler's default template depth limit, timed, and with a tight limit
+// standing in for chains nested inside other generated templates.
+//
+//     pointerChainBenchmark [--limit depth] [depths...]
+//
+// Depths default to 1 10 50 100 250 500; the tight limit defaults to 128.
+
+#ifndef POINTER_CHAIN_COMPILER
+#define POINTER_CHAIN_COMPILER "c++"
+#endif
+
+#ifndef POINTER_CHAIN_SOURCE
+#define POINTER_CHAIN_SOURCE "pointerChain.cpp"
+#endif
+
+struct Result {
+    bool ok;
+    double seconds;
+};
+
+Result compile(size_t depth, bool naive, int limit) {
+    string command = POINTER_CHAIN_COMPILER " -std=c++20 -fsyntax-only"
+                     " -DCHAIN_DEPTH=" + to_string(depth)
+                     + " -DNAIVE_TRAITS=" + (naive ? "1" : "0");
+    if (limit > 0) {
+        command += " -ftemplate-depth=" + to_string(limit);
+    }
+    command += " " POINTER_CHAIN_SOURCE " > /dev/null 2>&1";
+    auto start = chrono::steady_clock::now();
+    int status = system(command.c_str());
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return {status == 0, elapsed.count()};
+}
+
+void printTime(const Result& result) {
+    if (result.ok) {
+        cout << setw(12) << fixed << setprecision(2) << result.seconds;
+    } else {
+        cout << setw(12) << "failed";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int limit = 128;
+    vector<size_t> depths;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--limit" && i + 1 < argc) {
+            limit = stoi(argv[++i]);
+        } else {
+            depths.push_back(stoul(arg));
+        }
+    }
+    if (depths.empty()) {
+        depths = {1, 10, 50, 100, 250, 500};
+    }
+
+    cout << "Compile time (s) of pointerChain.cpp; last two columns compiled with"
+         << " -ftemplate-depth=" << limit << endl;
+    cout << setw(8) << "depth" << setw(12) << "naive" << setw(12) << "traits.h"
+         << setw(14) << "naive@limit" << setw(14) << "traits@limit" << endl;
+    for (size_t depth : depths) {
+        cout << setw(8) << depth << flush;
+        printTime(compile(depth, true, 0));
+        printTime(compile(depth, false, 0));
+        cout << setw(14) << (compile(depth, true, limit).ok ? "ok" : "failed")
+             << setw(14) << (compile(depth, false, limit).ok ? "ok" : "failed") << endl;
+    }
+    return 0;
+}
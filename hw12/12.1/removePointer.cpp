@@ -1,21 +1,8 @@
+#include "traits.h"
 #include <iostream>
+#include <string>
 #include <type_traits>
 
-template<class T>
-struct remove_all_pointers {
-    using type = T; // Return transformed type in type
-};
-
-// Specialization for pointer types
-template<class T>
-struct remove_all_pointers<T*> {
-    using type = typename remove_all_pointers<T>::type;
-};
-
-// Helper alias template
-template<class T>
-using remove_all_pointers_t = typename remove_all_pointers<T>::type;
-
 template<typename T>
 void f(T t) {
     remove_all_pointers_t<T> rt;
@@ -47,6 +34,60 @@ int main() {
     f(value);        // T is int
     f(ptr);          // T is int*
     f(ptr_to_ptr);   // T is int**
+
+    std::cout << "\npointer_depth_v<int***> = " << pointer_depth_v<int***> << std::endl;
+    std::cout << "remove_all_qualifiers_t<const int* const (&)[4]> is same as int: "
+              << std::is_same<int, remove_all_qualifiers_t<const int* const (&)[4]>>::value << std::endl;
+
+    // Compile-time checks of the whole trait library
+    static_assert(std::is_same_v<remove_all_pointers_t<int>, int>);
+    static_assert(std::is_same_v<remove_all_pointers_t<int***>, int>);
+    static_assert(std::is_same_v<remove_all_pointers_t<const int* const* volatile>, const int>);
+    static_assert(std::is_same_v<remove_all_pointers_t<int* (*)[3]>, int* [3]>);
+    static_assert(std::is_same_v<remove_all_pointers_t<int*&>, int*&>, "references are not pointers");
+    static_assert(std::is_same_v<remove_all_pointers_t<int****************>, int>, "16 layers");
+    static_assert(std::is_same_v<remove_all_pointers_t<int*****************>, int>, "17 layers");
+
+    static_assert(pointer_depth_v<int> == 0);
+    static_assert(pointer_depth_v<int*> == 1);
+    static_assert(pointer_depth_v<int* const* volatile*> == 3);
+    static_assert(pointer_depth_v<int********> == 8);
+    static_assert(pointer_depth_v<int*********> == 9);
+    static_assert(pointer_depth_v<int****************> == 16);
+    static_assert(pointer_depth_v<void (*)()> == 1);
+
+    static_assert(std::is_same_v<my_remove_cvref_t<const volatile int&>, int>);
+    static_assert(std::is_same_v<my_remove_cvref_t<const int*&&>, const int*>);
+
+    static_assert(std::is_same_v<remove_all_qualifiers_t<int>, int>);
+    static_assert(std::is_same_v<remove_all_qualifiers_t<const int* const (&)[4]>, int>);
+    static_assert(std::is_same_v<remove_all_qualifiers_t<volatile int (* const* )[2][3]>, int>);
+    static_assert(std::is_same_v<remove_all_qualifiers_t<const char* const* const&&>, char>);
+
+    static_assert(std::is_same_v<my_decay_t<const int&>, int>);
+    static_assert(std::is_same_v<my_decay_t<int[4]>, int*>);
+    static_assert(std::is_same_v<my_decay_t<const int (&)[4]>, const int*>);
+    static_assert(std::is_same_v<my_decay_t<void(int)>, void (*)(int)>);
+    static_assert(std::is_same_v<my_decay_t<int* const>, int*>);
+
+    using plain = function_traits<double(int, const std::string&)>;
+    static_assert(std::is_same_v<plain::return_type, double>);
+    static_assert(std::is_same_v<plain::arg_t<1>, const std::string&>);
+    static_assert(std::is_same_v<plain::args_tuple, std::tuple<int, const std::string&>>);
+    static_assert(plain::arg_count == 2 && !plain::is_noexcept && !plain::is_variadic);
+
+    static_assert(function_traits<int (*)(const char*, ...) noexcept>::is_variadic);
+    static_assert(function_traits<int (&)(const char*, ...) noexcept>::is_noexcept);
+    static_assert(function_traits<void() noexcept>::arg_count == 0);
+
+    using member = function_traits<long (std::string::*)(char, int) const & noexcept>;
+    static_assert(std::is_same_v<member::class_type, std::string>);
+    static_assert(std::is_same_v<member::signature, long(char, int)>);
+    static_assert(member::is_noexcept);
+
+    auto lambda = [](int a, double b) { return a * b; };
+    using closure = function_traits<decltype(lambda)>;
+    static_assert(std::is_same_v<closure::signature, double(int, double)>);
     
     return 0;
 }
\ No newline at end of file
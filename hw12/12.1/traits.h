@@ -0,0 +1,324 @@
+#ifndef TRAITS_H
+#define TRAITS_H
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+// Header-only trait library grown from remove_all_pointers (12.1) and
+// my_is_reference / my_remove_reference (12.2). Every trait is usable in
+// constant expressions and is checked with static_assert in
+// removePointer.cpp and reference.cpp.
+//
+// Traits that peel pointer layers off a type do not recurse once per
+// layer. Each instantiation removes up to eight layers, so a
+// chain of 500 pointers needs 63 nested instantiations instead of 500 and
+// stays far below the compiler's template depth limit. Where the compiler
+// provides a builtin (__remove_pointer, __remove_cvref, __decay, ...) the
+// single-layer step is the builtin itself and instantiates nothing.
+
+#if defined(__has_builtin)
+#if __has_builtin(__remove_pointer)
+#define TRAITS_BUILTIN_REMOVE_POINTER 1
+#endif
+#if __has_builtin(__remove_cvref)
+#define TRAITS_BUILTIN_REMOVE_CVREF 1
+#endif
+#if __has_builtin(__decay)
+#define TRAITS_BUILTIN_DECAY 1
+#endif
+#endif
+
+// my_is_reference
+template<class T>
+struct my_is_reference {
+    static constexpr bool value = false;
+};
+
+// Specialization for lvalue references
+template<class T>
+struct my_is_reference<T&> {
+    static constexpr bool value = true;
+};
+
+// Specialization for rvalue references
+template<class T>
+struct my_is_reference<T&&> {
+    static constexpr bool value = true;
+};
+
+// Helper variable template
+template<class T>
+inline constexpr bool my_is_reference_v = my_is_reference<T>::value;
+
+// my_remove_reference
+template<class T>
+struct my_remove_reference {
+    using type = T;
+};
+
+// Specialization for lvalue references
+template<class T>
+struct my_remove_reference<T&> {
+    using type = T;
+};
+
+// Specialization for rvalue references
+template<class T>
+struct my_remove_reference<T&&> {
+    using type = T;
+};
+
+// Helper alias template
+template<class T>
+using my_remove_reference_t = typename my_remove_reference<T>::type;
+
+namespace traits_detail {
+
+// One pointer layer off T, including const/volatile pointers; T itself if
+// it is not a pointer
+#ifdef TRAITS_BUILTIN_REMOVE_POINTER
+template<class T>
+using strip_pointer_t = __remove_pointer(T);
+#else
+template<class T>
+struct strip_pointer {
+    using type = T;
+};
+
+template<class T>
+struct strip_pointer<T*> {
+    using type = T;
+};
+
+template<class T>
+struct strip_pointer<T* const> {
+    using type = T;
+};
+
+template<class T>
+struct strip_pointer<T* volatile> {
+    using type = T;
+};
+
+template<class T>
+struct strip_pointer<T* const volatile> {
+    using type = T;
+};
+
+template<class T>
+using strip_pointer_t = typename strip_pointer<T>::type;
+#endif
+
+// Eight layers at once. The nested aliases are resolved one after the
+// other, so they add nothing to the instantiation depth.
+template<class T>
+using strip_pointer2_t = strip_pointer_t<strip_pointer_t<T>>;
+
+template<class T>
+using strip_pointer4_t = strip_pointer2_t<strip_pointer2_t<T>>;
+
+template<class T>
+using strip_pointer8_t = strip_pointer4_t<strip_pointer4_t<T>>;
+
+// Pointer layers among the first eight
+template<class T>
+inline constexpr std::size_t pointers_in_8 =
+    std::is_pointer_v<T> + std::is_pointer_v<strip_pointer_t<T>>
+    + std::is_pointer_v<strip_pointer2_t<T>>
+    + std::is_pointer_v<strip_pointer_t<strip_pointer2_t<T>>>
+    + std::is_pointer_v<strip_pointer4_t<T>>
+    + std::is_pointer_v<strip_pointer_t<strip_pointer4_t<T>>>
+    + std::is_pointer_v<strip_pointer2_t<strip_pointer4_t<T>>>
+    + std::is_pointer_v<strip_pointer_t<strip_pointer2_t<strip_pointer4_t<T>>>>;
+
+template<class T, bool = std::is_pointer_v<strip_pointer8_t<T>>>
+struct remove_all_pointers_impl {
+    using type = strip_pointer8_t<T>;
+};
+
+template<class T>
+struct remove_all_pointers_impl<T, true> {
+    using type = typename remove_all_pointers_impl<strip_pointer8_t<T>>::type;
+};
+
+template<class T, bool = std::is_pointer_v<strip_pointer8_t<T>>>
+struct pointer_depth_impl {
+    static constexpr std::size_t value = pointers_in_8<T>;
+};
+
+template<class T>
+struct pointer_depth_impl<T, true> {
+    static constexpr std::size_t value = 8 + pointer_depth_impl<strip_pointer8_t<T>>::value;
+};
+
+} // namespace traits_detail
+
+// remove_all_pointers: int*** -> int, const int* const* -> const int
+template<class T>
+struct remove_all_pointers {
+    using type = typename traits_detail::remove_all_pointers_impl<T>::type;
+};
+
+// Helper alias template
+template<class T>
+using remove_all_pointers_t = typename remove_all_pointers<T>::type;
+
+// pointer_depth: number of pointer layers, int** -> 2
+template<class T>
+struct pointer_depth {
+    static constexpr std::size_t value = traits_detail::pointer_depth_impl<T>::value;
+};
+
+template<class T>
+inline constexpr std::size_t pointer_depth_v = pointer_depth<T>::value;
+
+// my_remove_cvref: reference, then const/volatile
+template<class T>
+struct my_remove_cvref {
+#ifdef TRAITS_BUILTIN_REMOVE_CVREF
+    using type = __remove_cvref(T);
+#else
+    using type = std::remove_cv_t<my_remove_reference_t<T>>;
+#endif
+};
+
+template<class T>
+using my_remove_cvref_t = typename my_remove_cvref<T>::type;
+
+namespace traits_detail {
+
+// Strips extents, cv and pointers, then goes round again while a pointer
+// to an array or an array of pointers is left
+template<class T, bool = std::is_array_v<T> || std::is_pointer_v<T>>
+struct remove_all_qualifiers_impl {
+    using type = std::remove_cv_t<T>;
+};
+
+template<class T>
+struct remove_all_qualifiers_impl<T, true> {
+    using type = typename remove_all_qualifiers_impl<
+        remove_all_pointers_t<std::remove_cv_t<std::remove_all_extents_t<T>>>>::type;
+};
+
+} // namespace traits_detail
+
+// remove_all_qualifiers: strips references, const/volatile at every
+// level, pointers and array extents down to the underlying type:
+// const int* const (&)[4] -> int
+template<class T>
+struct remove_all_qualifiers {
+    using type = typename traits_detail::remove_all_qualifiers_impl<my_remove_cvref_t<T>>::type;
+};
+
+template<class T>
+using remove_all_qualifiers_t = typename remove_all_qualifiers<T>::type;
+
+// my_decay: what a by-value parameter of type T becomes; arrays and
+// functions turn into pointers, references and top-level cv disappear
+template<class T>
+struct my_decay {
+#ifdef TRAITS_BUILTIN_DECAY
+    using type = __decay(T);
+#else
+    using U = my_remove_reference_t<T>;
+    using type = std::conditional_t<std::is_array_v<U>, std::remove_extent_t<U>*,
+                 std::conditional_t<std::is_function_v<U>, std::add_pointer_t<U>,
+                                    std::remove_cv_t<U>>>;
+#endif
+};
+
+template<class T>
+using my_decay_t = typename my_decay<T>::type;
+
+// function_traits: decomposes a function type, a pointer or reference to
+// one, a pointer to member function (any cv/ref/noexcept qualifiers) or a
+// class with a single operator() such as a lambda
+//     return_type    the result
+//     args_tuple     std::tuple of the parameter types
+//     arg_t<I>       the I-th parameter type
+//     arg_count      number of parameters
+//     signature      R(Args...) without qualifiers
+//     is_noexcept, is_variadic
+//     class_type     for member functions only
+template<class F>
+struct function_traits : function_traits<decltype(&F::operator())> {
+};
+
+template<class R, class... Args>
+struct function_traits<R(Args...)> {
+    using return_type = R;
+    using args_tuple = std::tuple<Args...>;
+    using signature = R(Args...);
+    static constexpr std::size_t arg_count = sizeof...(Args);
+    static constexpr bool is_noexcept = false;
+    static constexpr bool is_variadic = false;
+
+    template<std::size_t I>
+    using arg_t = std::tuple_element_t<I, args_tuple>;
+};
+
+template<class R, class... Args>
+struct function_traits<R(Args..., ...)> : function_traits<R(Args...)> {
+    static constexpr bool is_variadic = true;
+};
+
+template<class R, class... Args>
+struct function_traits<R(Args...) noexcept> : function_traits<R(Args...)> {
+    static constexpr bool is_noexcept = true;
+};
+
+template<class R, class... Args>
+struct function_traits<R(Args..., ...) noexcept> : function_traits<R(Args..., ...)> {
+    static constexpr bool is_noexcept = true;
+};
+
+template<class F>
+struct function_traits<F*> : function_traits<F> {
+};
+
+template<class F>
+struct function_traits<F&> : function_traits<F> {
+};
+
+template<class F>
+struct function_traits<F&&> : function_traits<F> {
+};
+
+template<class F, class C>
+struct function_traits<F C::*> : function_traits<F> {
+    using class_type = C;
+};
+
+// Member function types carry cv/ref qualifiers; each combination maps
+// onto the unqualified type
+#define TRAITS_QUALIFIED_FUNCTION(QUALIFIERS)                                         \
+    template<class R, class... Args>                                                 \
+    struct function_traits<R(Args...) QUALIFIERS> : function_traits<R(Args...)> {    \
+    };                                                                               \
+    template<class R, class... Args>                                                 \
+    struct function_traits<R(Args..., ...) QUALIFIERS>                               \
+        : function_traits<R(Args..., ...)> {                                         \
+    };                                                                               \
+    template<class R, class... Args>                                                 \
+    struct function_traits<R(Args...) QUALIFIERS noexcept>                           \
+        : function_traits<R(Args...) noexcept> {                                     \
+    };                                                                               \
+    template<class R, class... Args>                                                 \
+    struct function_traits<R(Args..., ...) QUALIFIERS noexcept>                      \
+        : function_traits<R(Args..., ...) noexcept> {                                \
+    };
+
+TRAITS_QUALIFIED_FUNCTION(const)
+TRAITS_QUALIFIED_FUNCTION(volatile)
+TRAITS_QUALIFIED_FUNCTION(const volatile)
+TRAITS_QUALIFIED_FUNCTION(&)
+TRAITS_QUALIFIED_FUNCTION(const &)
+TRAITS_QUALIFIED_FUNCTION(volatile &)
+TRAITS_QUALIFIED_FUNCTION(const volatile &)
+TRAITS_QUALIFIED_FUNCTION(&&)
+TRAITS_QUALIFIED_FUNCTION(const &&)
+TRAITS_QUALIFIED_FUNCTION(volatile &&)
+TRAITS_QUALIFIED_FUNCTION(const volatile &&)
+#undef TRAITS_QUALIFIED_FUNCTION
+
+#endif
@@ -1,48 +1,8 @@
+#include "../12.1/traits.h"
 #include <iostream>
 #include <type_traits>
 
-template<class T>
-struct my_is_reference {
-    static constexpr bool value = false;
-};
-
-// Specialization for lvalue references
-template<class T>
-struct my_is_reference<T&> {
-    static constexpr bool value = true;
-};
-
-// Specialization for rvalue references
-template<class T>
-struct my_is_reference<T&&> {
-    static constexpr bool value = true;
-};
-
-// Helper variable template
-template<class T>
-inline constexpr bool my_is_reference_v = my_is_reference<T>::value;
-
-
-template<class T>
-struct my_remove_reference {
-    using type = T;
-};
-
-// Specialization for lvalue references
-template<class T>
-struct my_remove_reference<T&> {
-    using type = T;
-};
-
-// Specialization for rvalue references
-template<class T>
-struct my_remove_reference<T&&> {
-    using type = T;
-};
-
-// Helper alias template
-template<class T>
-using my_remove_reference_t = typename my_remove_reference<T>::type;
+// my_is_reference and my_remove_reference live in ../12.1/traits.h
 
 int main() {
     // Test is_reference trait
@@ -90,6 +50,13 @@ int main() {
     static_assert(std::is_same<int, my_remove_reference_t<int>>::value, "my_remove_reference_t<int> should be int");
     static_assert(std::is_same<int, my_remove_reference_t<int&>>::value, "my_remove_reference_t<int&> should be int");
     static_assert(std::is_same<int, my_remove_reference_t<int&&>>::value, "my_remove_reference_t<int&&> should be int");
+
+    static_assert(!my_is_reference_v<int*>, "pointers are not references");
+    static_assert(my_is_reference_v<int (&)[3]>, "references to arrays are references");
+    static_assert(my_is_reference_v<void (&&)()>, "references to functions are references");
+    static_assert(std::is_same<const int, my_remove_reference_t<const int&>>::value, "cv is kept");
+    static_assert(std::is_same<int[3], my_remove_reference_t<int (&)[3]>>::value, "array references");
+    static_assert(std::is_same<int*, my_remove_reference_t<int*&&>>::value, "pointer references");
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "factory.h"
+#include "../12.4/flexible_factory.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+using namespace std;
+using namespace cspp51045;
+
+// Multi-threaded creation benchmark: every thread shares one factory and
+// repeatedly creates and destroys a batch of products.
+
+struct Locomotive {
+    virtual double getHorsepower() const = 0;
+    virtual ~Locomotive() = default;
+};
+
+struct FreightCar {
+    virtual long getCapacity() const = 0;
+    virtual ~FreightCar() = default;
+};
+
+struct ModelLocomotive : public Locomotive {
+    ModelLocomotive() = default;
+    ModelLocomotive(double hp) : horsepower(hp) {}
+    double getHorsepower() const override { return horsepower; }
+    double horsepower = 75.5;
+};
+
+struct ModelFreightCar : public FreightCar {
+    ModelFreightCar() = default;
+    ModelFreightCar(long cap) : capacity(cap) {}
+    long getCapacity() const override { return capacity; }
+    long capacity = 250;
+};
+
+using TrainFactory = abstract_factory<Locomotive, FreightCar>;
+using HeapTrainFactory = concrete_factory<TrainFactory, ModelLocomotive, ModelFreightCar>;
+using CachedTrainFactory = thread_cached_factory<TrainFactory, ModelLocomotive, ModelFreightCar>;
+
+using FlexibleTrainFactory = flexible_abstract_factory<Locomotive(double), FreightCar(long)>;
+using HeapFlexibleFactory
+    = flexible_concrete_factory<FlexibleTrainFactory, ModelLocomotive, ModelFreightCar>;
+using CachedFlexibleFactory
+    = thread_cached_flexible_factory<FlexibleTrainFactory, ModelLocomotive, ModelFreightCar>;
+
+const size_t BATCH = 64;
+const size_t OBJECTS_PER_THREAD = 1 << 19;
+
+void create_batch(TrainFactory& factory, vector<unique_ptr<Locomotive>>& locos,
+                  vector<unique_ptr<FreightCar>>& cars) {
+    for (size_t i = 0; i < BATCH / 2; ++i) {
+        locos.push_back(factory.create<Locomotive>());
+        cars.push_back(factory.create<FreightCar>());
+    }
+}
+
+void create_batch(FlexibleTrainFactory& factory, vector<unique_ptr<Locomotive>>& locos,
+                  vector<unique_ptr<FreightCar>>& cars) {
+    for (size_t i = 0; i < BATCH / 2; ++i) {
+        locos.push_back(factory.create<Locomotive>(120.5));
+        cars.push_back(factory.create<FreightCar>(5000L));
+    }
+}
+
+// Returns objects created per second across all threads
+template<typename Factory>
+double run(Factory& factory, size_t threads) {
+    vector<thread> workers;
+    auto start = chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&factory]() {
+            vector<unique_ptr<Locomotive>> locos;
+            vector<unique_ptr<FreightCar>> cars;
+            locos.reserve(BATCH);
+            cars.reserve(BATCH);
+            for (size_t n = 0; n < OBJECTS_PER_THREAD; n += BATCH) {
+                create_batch(factory, locos, cars);
+                locos.clear();
+                cars.clear();
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return threads * OBJECTS_PER_THREAD / elapsed.count();
+}
+
+int main() {
+    HeapTrainFactory heapFactory;
+    CachedTrainFactory cachedFactory;
+    HeapFlexibleFactory heapFlexible;
+    CachedFlexibleFactory cachedFlexible;
+
+    cout << "Objects/sec with one shared factory (" << OBJECTS_PER_THREAD
+         << " objects per thread)" << endl;
+    cout << setw(8) << "threads"
+         << setw(16) << "heap"
+         << setw(16) << "thread_cached"
+         << setw(16) << "flex heap"
+         << setw(16) << "flex cached" << endl;
+
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        cout << setw(8) << threads
+             << setw(16) << fixed << setprecision(0) << run<TrainFactory>(heapFactory, threads)
+             << setw(16) << run<TrainFactory>(cachedFactory, threads)
+             << setw(16) << run<FlexibleTrainFactory>(heapFlexible, threads)
+             << setw(16) << run<FlexibleTrainFactory>(cachedFlexible, threads) << endl;
+    }
+    return 0;
+}
@@ -2,6 +2,7 @@
 #define FACTORY_H
 #include<tuple>
 #include<memory>
+#include "thread_cache.h"
 using std::tuple;
 using std::unique_ptr;
 using std::make_unique;
@@ -17,6 +18,9 @@ struct abstract_creator {
     virtual unique_ptr<T> doCreate(TT<T> &&) = 0;
 };
 
+// Concrete factories hold no state, so a single factory may be shared by
+// any number of threads calling create() concurrently. Products come from
+// the global heap; see thread_cached_factory to avoid contending there.
 template<typename... Ts>
 struct abstract_factory : public abstract_creator<Ts>... {
 
@@ -43,5 +47,12 @@ struct concrete_factory
   : public concrete_creator<abstract_factory<AbstractTypes...>, 
 	                        AbstractTypes, ConcreteTypes>... {
 };
+
+// Thread-safe creation mode: each product is allocated from the creating
+// thread's block cache (see thread_cache.h), so many threads can share one
+// factory without serializing in the global allocator.
+template<typename AbstractFactory, typename... ConcreteTypes>
+using thread_cached_factory
+  = concrete_factory<AbstractFactory, thread_cached<ConcreteTypes>...>;
 }
 #endif
@@ -0,0 +1,69 @@
+#include "factory.h"
+#include "flat_factory.h"
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <utility>
+using namespace std;
+using namespace cspp51045;
+
+// One translation unit with a product family of PRODUCT_COUNT types,
+// built either on abstract_factory/concrete_factory (FLAT_FACTORY=0) or on
+// the flat creator table (FLAT_FACTORY=1). factoryScaleBenchmark compiles
+// it for several sizes and compares compile time and binary size.
+
+#ifndef PRODUCT_COUNT
+#define PRODUCT_COUNT 10
+#endif
+
+#ifndef FLAT_FACTORY
+#define FLAT_FACTORY 1
+#endif
+
+template<size_t I>
+struct Product {
+    virtual size_t id() const = 0;
+    virtual ~Product() = default;
+};
+
+template<size_t I>
+struct ModelProduct : public Product<I> {
+    size_t id() const override { return I; }
+};
+
+template<typename Indices>
+struct Family;
+
+template<size_t... Is>
+struct Family<index_sequence<Is...>> {
+#if FLAT_FACTORY
+    using Abstract = flat_abstract_factory<Product<Is>...>;
+    using Concrete = flat_concrete_factory<Abstract, ModelProduct<Is>...>;
+#else
+    using Abstract = abstract_factory<Product<Is>...>;
+    using Concrete = concrete_factory<Abstract, ModelProduct<Is>...>;
+#endif
+
+    // A separate call per product, so each product is destroyed before the
+    // next one is created rather than all at the end of one expression
+    template<size_t I>
+    static size_t createOne(Abstract& factory) {
+        return factory.template create<Product<I>>()->id();
+    }
+
+    // Creates every product once, so every creator is instantiated
+    static size_t createAll(Abstract& factory) {
+        return (createOne<Is>(factory) + ...);
+    }
+};
+
+using ProductFamily = Family<make_index_sequence<PRODUCT_COUNT>>;
+
+int main() {
+    unique_ptr<ProductFamily::Abstract> factory = make_unique<ProductFamily::Concrete>();
+    size_t sum = ProductFamily::createAll(*factory);
+    size_t expected = size_t(PRODUCT_COUNT) * (PRODUCT_COUNT - 1) / 2;
+    cout << (FLAT_FACTORY ? "flat" : "inheritance") << " factory of " << PRODUCT_COUNT
+         << " products: " << (sum == expected ? "ok" : "wrong products") << endl;
+    return sum == expected ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Compile-time and binary-size benchmark: compiles factoryScale.cpp for
+// product families of several sizes, once with the inheritance-based
+// concrete_factory and once with the flat creator table, and reports how
+// long each compile took and how big the stripped executable is.
+//
+//     factoryScaleBenchmark [--timeout seconds] [sizes...]
+//
+// Sizes default to 10 100 1000. The inheritance layout grows
+// quadratically, so a compile that runs past the timeout (600 s by
+// default) is reported as such instead of waiting for it.
+
+#ifndef FACTORY_SCALE_COMPILER
+#define FACTORY_SCALE_COMPILER "c++"
+#endif
+
+#ifndef FACTORY_SCALE_SOURCE
+#define FACTORY_SCALE_SOURCE "factoryScale.cpp"
+#endif
+
+struct Result {
+    bool ok;
+    double seconds;
+    uintmax_t bytes;
+};
+
+Result build(size_t products, bool flat, int timeout, const filesystem::path& output) {
+    string command = "timeout " + to_string(timeout) + " " FACTORY_SCALE_COMPILER
+                     " -std=c++20 -O2 -s"
+                     " -DPRODUCT_COUNT=" + to_string(products)
+                     + " -DFLAT_FACTORY=" + (flat ? "1" : "0")
+                     + " " FACTORY_SCALE_SOURCE " -o " + output.string();
+    auto start = chrono::steady_clock::now();
+    int status = system(command.c_str());
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    if (status != 0) {
+        return {false, elapsed.count(), 0};
+    }
+    // The program checks that every product was created
+    string check = output.string() + " > /dev/null";
+    if (system(check.c_str()) != 0) {
+        return {false, elapsed.count(), 0};
+    }
+    return {true, elapsed.count(), filesystem::file_size(output)};
+}
+
+void print(const Result& result, int timeout) {
+    if (result.ok) {
+        cout << setw(12) << fixed << setprecision(1) << result.seconds
+             << setw(14) << result.bytes;
+    } else if (result.seconds >= timeout) {
+        cout << setw(26) << "timed out";
+    } else {
+        cout << setw(26) << "failed";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int timeout = 600;
+    vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--timeout" && i + 1 < argc) {
+            timeout = stoi(argv[++i]);
+        } else {
+            sizes.push_back(stoul(arg));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {10, 100, 1000};
+    }
+
+    filesystem::path output = filesystem::temp_directory_path() / "factoryScale.out";
+
+    cout << "Compile time (s) and stripped size (bytes) of factoryScale.cpp" << endl;
+    cout << setw(10) << "products"
+         << setw(12) << "inherit s" << setw(14) << "inherit bytes"
+         << setw(12) << "flat s" << setw(14) << "flat bytes" << endl;
+    for (size_t products : sizes) {
+        cout << setw(10) << products << flush;
+        print(build(products, false, timeout, output), timeout);
+        cout << flush;
+        print(build(products, true, timeout, output), timeout);
+        cout << endl;
+    }
+    filesystem::remove(output);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#ifndef FLAT_FACTORY_H
+#define FLAT_FACTORY_H
+#include <memory>
+#include "thread_cache.h"
+#include "type_list.h"
+using std::unique_ptr;
+
+namespace cspp51045 {
+
+// Abstract factory backed by a flat table of creator functions instead of
+// one virtual base per product. abstract_factory<Ts...> and
+// concrete_factory derive from N creator classes, and since every concrete
+// creator virtually inherits the whole abstract factory, each of them
+// carries its own N-entry vtable: compile time and binary size grow with
+// N squared. Here a concrete factory is one class holding a pointer to a
+// static array of N function pointers, and create<U>() indexes it at a
+// position found at compile time.
+//
+// Like concrete_factory, a flat factory holds no mutable state and may be
+// shared by any number of threads calling create() concurrently.
+template<typename... Ts>
+class flat_abstract_factory {
+public:
+    using products = type_list<Ts...>;
+
+    template<class U> unique_ptr<U> create() const {
+        constexpr std::size_t index = index_of_v<U, products>;
+        static_assert(index < products::size, "U is not a product of this factory");
+        // The creator returned a U* converted to void*
+        return unique_ptr<U>(static_cast<U*>(creators_[index]()));
+    }
+
+    virtual ~flat_abstract_factory() = default;
+
+protected:
+    using creator = void* (*)();
+
+    explicit flat_abstract_factory(const creator* creators) : creators_(creators) {}
+
+private:
+    const creator* creators_;
+};
+
+template<typename AbstractFactory, typename... ConcreteTypes>
+struct flat_concrete_factory;
+
+template<typename... AbstractTypes, typename... ConcreteTypes>
+struct flat_concrete_factory<flat_abstract_factory<AbstractTypes...>, ConcreteTypes...>
+  : public flat_abstract_factory<AbstractTypes...> {
+    static_assert(sizeof...(AbstractTypes) == sizeof...(ConcreteTypes),
+                  "one concrete type per product");
+
+    flat_concrete_factory() : flat_abstract_factory<AbstractTypes...>(creators) {}
+
+private:
+    using creator = typename flat_abstract_factory<AbstractTypes...>::creator;
+
+    template<typename Abstract, typename Concrete>
+    static void* make() {
+        return static_cast<Abstract*>(new Concrete());
+    }
+
+    static constexpr creator creators[] = {&make<AbstractTypes, ConcreteTypes>...};
+};
+
+// Flat factory whose products come from the creating thread's block cache
+template<typename AbstractFactory, typename... ConcreteTypes>
+using thread_cached_flat_factory
+  = flat_concrete_factory<AbstractFactory, thread_cached<ConcreteTypes>...>;
+}
+#endif
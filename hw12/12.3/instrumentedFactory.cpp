@@ -0,0 +1,67 @@
+#include "instrumented_factory.h"
+#include <iostream>
+#include <memory>
+#include <vector>
+using namespace std;
+using namespace cspp51045;
+
+struct Locomotive {
+    virtual void display() = 0;
+    virtual ~Locomotive() = default;
+};
+
+struct FreightCar {
+    virtual void display() = 0;
+    virtual ~FreightCar() = default;
+};
+
+struct Caboose {
+    virtual void display() = 0;
+    virtual ~Caboose() = default;
+};
+
+struct ModelLocomotive : public Locomotive {
+    void display() override {
+        cout << "Model locomotive" << endl;
+    }
+};
+
+struct ModelFreightCar : public FreightCar {
+    void display() override {
+        cout << "Model freight car" << endl;
+    }
+};
+
+struct ModelCaboose : public Caboose {
+    void display() override {
+        cout << "Model caboose" << endl;
+    }
+};
+
+using TrainFactory = abstract_factory<Locomotive, FreightCar, Caboose>;
+using ModelTrainFactory = 
+    concrete_factory<TrainFactory, ModelLocomotive, ModelFreightCar, ModelCaboose>;
+using InstrumentedTrainFactory = instrumented_factory<TrainFactory>;
+
+int main() {
+    InstrumentedTrainFactory factory(make_unique<ModelTrainFactory>());
+
+    auto locomotive = factory.create<Locomotive>();
+    vector<InstrumentedTrainFactory::product_ptr<FreightCar>> freightCars;
+    for (int i = 0; i < 20; ++i) {
+        freightCars.push_back(factory.create<FreightCar>());
+    }
+    auto caboose = factory.create<Caboose>();
+
+    // Retire half of the freight cars so the live gauge drops
+    freightCars.resize(10);
+
+    cout << factory.snapshot().to_json() << endl;
+
+    // Names for reports can also be given; they are escaped into the JSON
+    InstrumentedTrainFactory named(make_unique<ModelTrainFactory>(),
+                                   {"locomotive", "freight car", "caboose \"end of train\""});
+    auto lastCaboose = named.create<Caboose>();
+    cout << named.snapshot().to_json() << endl;
+    return 0;
+}
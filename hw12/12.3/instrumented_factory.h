@@ -0,0 +1,223 @@
+#ifndef INSTRUMENTED_FACTORY_H
+#define INSTRUMENTED_FACTORY_H
+#include "factory.h"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <type_traits>
+#include <vector>
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+// Define FACTORY_INSTRUMENTATION to turn on counting. Without it,
+// instrumented_factory forwards straight to the wrapped factory, hands out
+// plain unique_ptrs and reports an empty snapshot.
+
+namespace cspp51045 {
+
+// Bucket i counts creations that took [2^(i-1), 2^i) nanoseconds
+inline constexpr std::size_t latency_buckets = 32;
+
+struct product_stats {
+    std::string name;
+    std::uint64_t created = 0;
+    std::uint64_t live = 0;
+    std::array<std::uint64_t, latency_buckets> latency_ns{};
+};
+
+// Readable name of T: demangled where the ABI library can do it,
+// otherwise whatever typeid reports
+template<typename T>
+std::string type_name() {
+    const char* mangled = typeid(T).name();
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> demangled(
+        abi::__cxa_demangle(mangled, nullptr, nullptr, &status), std::free);
+    if (status == 0 && demangled) {
+        return demangled.get();
+    }
+#endif
+    return mangled;
+}
+
+// s as a JSON string literal, quotes included
+inline std::string json_string(std::string_view s) {
+    std::string out = "\"";
+    for (char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escape[7];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+                out += escape;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out + '"';
+}
+
+struct factory_snapshot {
+    std::vector<product_stats> products;
+
+    std::string to_json() const {
+        std::string out = "{\"products\":[";
+        for (std::size_t i = 0; i < products.size(); ++i) {
+            const product_stats& p = products[i];
+            if (i != 0) {
+                out += ',';
+            }
+            out += "{\"name\":" + json_string(p.name);
+            out += ",\"created\":" + std::to_string(p.created);
+            out += ",\"live\":" + std::to_string(p.live);
+            out += ",\"latency_ns_log2\":[";
+            for (std::size_t b = 0; b < latency_buckets; ++b) {
+                if (b != 0) {
+                    out += ',';
+                }
+                out += std::to_string(p.latency_ns[b]);
+            }
+            out += "]}";
+        }
+        return out + "]}";
+    }
+};
+
+// Counters for one product type; updated with relaxed atomics only
+struct product_counters {
+    std::atomic<std::uint64_t> created{0};
+    std::atomic<std::uint64_t> live{0};
+    std::array<std::atomic<std::uint64_t>, latency_buckets> latency_ns{};
+
+    void record(std::chrono::nanoseconds elapsed) {
+        auto ns = static_cast<std::uint64_t>(elapsed.count());
+        std::size_t bucket = std::bit_width(ns);
+        if (bucket >= latency_buckets) {
+            bucket = latency_buckets - 1;
+        }
+        created.fetch_add(1, std::memory_order_relaxed);
+        live.fetch_add(1, std::memory_order_relaxed);
+        latency_ns[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+// Deleter that decrements the live-object gauge of the product's type
+template<typename T>
+struct counted_deleter {
+    std::atomic<std::uint64_t>* live = nullptr;
+
+    counted_deleter() = default;
+    explicit counted_deleter(std::atomic<std::uint64_t>* gauge) : live(gauge) {}
+
+    // Allows unique_ptr<Derived, ...> to convert to unique_ptr<Base, ...>
+    template<typename U, std::enable_if_t<std::is_convertible_v<U*, T*>, int> = 0>
+    counted_deleter(const counted_deleter<U>& other) : live(other.live) {}
+
+    void operator()(T* p) const {
+        delete p;
+        if (live) {
+            live->fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+template<typename U, typename... Ts>
+constexpr std::size_t product_index() {
+    constexpr bool matches[] = {std::is_same_v<U, Ts>...};
+    for (std::size_t i = 0; i < sizeof...(Ts); ++i) {
+        if (matches[i]) {
+            return i;
+        }
+    }
+    return sizeof...(Ts);
+}
+
+// Decorator around any concrete factory for abstract_factory<Ts...>.
+// Products must be destroyed before the decorator, since their deleters
+// point into its counters.
+template<typename AbstractFactory>
+class instrumented_factory;
+
+template<typename... Ts>
+class instrumented_factory<abstract_factory<Ts...>> {
+public:
+#ifdef FACTORY_INSTRUMENTATION
+    template<typename U>
+    using product_ptr = unique_ptr<U, counted_deleter<U>>;
+#else
+    template<typename U>
+    using product_ptr = unique_ptr<U>;
+#endif
+
+#ifdef FACTORY_INSTRUMENTATION
+    explicit instrumented_factory(unique_ptr<abstract_factory<Ts...>> factory)
+        : factory_(std::move(factory)), names_{type_name<Ts>()...} {}
+
+    // Reports the products under the given names, in the order of Ts
+    instrumented_factory(unique_ptr<abstract_factory<Ts...>> factory,
+                         std::array<std::string, sizeof...(Ts)> names)
+        : factory_(std::move(factory)), names_(std::move(names)) {}
+#else
+    explicit instrumented_factory(unique_ptr<abstract_factory<Ts...>> factory)
+        : factory_(std::move(factory)) {}
+
+    // Nothing is reported, so the names are not kept
+    instrumented_factory(unique_ptr<abstract_factory<Ts...>> factory, std::array<std::string, sizeof...(Ts)>)
+        : factory_(std::move(factory)) {}
+#endif
+
+    template<class U> product_ptr<U> create() {
+        abstract_creator<U> &creator = *factory_;
+#ifdef FACTORY_INSTRUMENTATION
+        constexpr std::size_t index = product_index<U, Ts...>();
+        auto start = std::chrono::steady_clock::now();
+        U* product = creator.doCreate(TT<U>()).release();
+        counters_[index].record(std::chrono::steady_clock::now() - start);
+        return product_ptr<U>(product, counted_deleter<U>(&counters_[index].live));
+#else
+        return creator.doCreate(TT<U>());
+#endif
+    }
+
+    factory_snapshot snapshot() const {
+        factory_snapshot result;
+#ifdef FACTORY_INSTRUMENTATION
+        for (std::size_t i = 0; i < sizeof...(Ts); ++i) {
+            product_stats stats;
+            stats.name = names_[i];
+            stats.created = counters_[i].created.load(std::memory_order_relaxed);
+            stats.live = counters_[i].live.load(std::memory_order_relaxed);
+            for (std::size_t b = 0; b < latency_buckets; ++b) {
+                stats.latency_ns[b] = counters_[i].latency_ns[b].load(std::memory_order_relaxed);
+            }
+            result.products.push_back(std::move(stats));
+        }
+#endif
+        return result;
+    }
+
+private:
+    unique_ptr<abstract_factory<Ts...>> factory_;
+#ifdef FACTORY_INSTRUMENTATION
+    std::array<std::string, sizeof...(Ts)> names_;
+    std::array<product_counters, sizeof...(Ts)> counters_;
+#endif
+};
+
+}
+#endif
@@ -0,0 +1,97 @@
+#ifndef THREAD_CACHE_H
+#define THREAD_CACHE_H
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace cspp51045 {
+
+// Per-thread free list of fixed-size blocks.
+// Every thread owns its own list, so a block is handed out or taken back
+// without locks and without touching the global allocator. A block freed on
+// another thread simply joins that thread's list. Lists are capped at
+// max_cached blocks and release their memory when the thread exits.
+template<std::size_t Size, std::size_t Align>
+class thread_block_cache {
+    struct block {
+        block* next;
+    };
+
+public:
+    static constexpr std::size_t block_size = Size < sizeof(block) ? sizeof(block) : Size;
+    static constexpr std::size_t block_align = Align < alignof(block) ? alignof(block) : Align;
+    static constexpr std::size_t max_cached = 4096;
+
+    static void* allocate() {
+        free_list& list = local();
+        if (block* b = list.head) {
+            list.head = b->next;
+            --list.count;
+            return b;
+        }
+        return ::operator new(block_size, std::align_val_t{block_align});
+    }
+
+    static void deallocate(void* p) noexcept {
+        free_list& list = local();
+        if (list.count < max_cached) {
+            list.head = ::new (p) block{list.head};
+            ++list.count;
+        } else {
+            ::operator delete(p, std::align_val_t{block_align});
+        }
+    }
+
+private:
+    struct free_list {
+        block* head = nullptr;
+        std::size_t count = 0;
+
+        ~free_list() {
+            while (head) {
+                block* next = head->next;
+                ::operator delete(head, std::align_val_t{block_align});
+                head = next;
+            }
+        }
+    };
+
+    static free_list& local() {
+        thread_local free_list list;
+        return list;
+    }
+};
+
+// Wraps a concrete product so that new/delete go through the calling
+// thread's block cache instead of the global heap.
+// Products are deleted through a pointer to their abstract base, so that
+// base needs a virtual destructor for the class-specific operator delete
+// to be picked.
+template<typename T>
+struct thread_cached : public T {
+    static_assert(std::has_virtual_destructor_v<T>,
+                  "thread_cached products must have a virtual destructor");
+
+    using T::T;
+
+    static void* operator new(std::size_t size) {
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+        return cache::allocate();
+    }
+
+    static void operator delete(void* p, std::size_t size) noexcept {
+        if (size != sizeof(T)) {
+            ::operator delete(p);
+            return;
+        }
+        cache::deallocate(p);
+    }
+
+private:
+    using cache = thread_block_cache<sizeof(T), alignof(T)>;
+};
+
+}
+#endif
@@ -0,0 +1,116 @@
+#ifndef TYPE_LIST_H
+#define TYPE_LIST_H
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Type lists and the traits over them, written in the same struct +
+// _t/_v style as remove_all_pointers and my_remove_reference. Lookups do
+// not recurse over the list: a list's elements become the bases of one
+// indexer class, and overload resolution against those bases finds a type
+// by index or an index by type. That costs one class instantiation per
+// list instead of one per element per lookup, which matters once product
+// families have hundreds of types.
+
+namespace cspp51045 {
+
+template<typename... Ts>
+struct type_list {
+    static constexpr std::size_t size = sizeof...(Ts);
+};
+
+namespace type_list_detail {
+
+template<std::size_t I, typename T>
+struct indexed {
+    using type = T;
+};
+
+template<typename Indices, typename... Ts>
+struct indexer;
+
+template<std::size_t... Is, typename... Ts>
+struct indexer<std::index_sequence<Is...>, Ts...> : indexed<Is, Ts>... {
+};
+
+template<typename... Ts>
+using indexer_for = indexer<std::index_sequence_for<Ts...>, Ts...>;
+
+// Deduction picks the one base with the requested index or type
+template<std::size_t I, typename T>
+indexed<I, T> select_at(const indexed<I, T>&);
+
+template<typename T, std::size_t I>
+std::integral_constant<std::size_t, I> select_index(const indexed<I, T>&);
+
+} // namespace type_list_detail
+
+// type_at: the I-th type of a list
+template<std::size_t I, typename List>
+struct type_at;
+
+template<std::size_t I, typename... Ts>
+struct type_at<I, type_list<Ts...>> {
+    static_assert(I < sizeof...(Ts), "type_at: index out of range");
+    using type = typename decltype(type_list_detail::select_at<I>(
+        std::declval<const type_list_detail::indexer_for<Ts...>&>()))::type;
+};
+
+template<std::size_t I, typename List>
+using type_at_t = typename type_at<I, List>::type;
+
+// index_of: position of T in a list, or the list's size if T is not in it
+template<typename T, typename List>
+struct index_of;
+
+template<typename T, typename... Ts>
+struct index_of<T, type_list<Ts...>> {
+private:
+    using indexer_type = type_list_detail::indexer_for<Ts...>;
+
+public:
+    static constexpr std::size_t value = [] {
+        if constexpr (requires(const indexer_type& list) {
+                          type_list_detail::select_index<T>(list);
+                      }) {
+            return decltype(type_list_detail::select_index<T>(
+                std::declval<const indexer_type&>()))::value;
+        } else {
+            return sizeof...(Ts);
+        }
+    }();
+};
+
+template<typename T, typename List>
+inline constexpr std::size_t index_of_v = index_of<T, List>::value;
+
+// contains
+template<typename T, typename List>
+inline constexpr bool contains_v = index_of_v<T, List> < List::size;
+
+// transform: applies a trait (anything with a nested ::type) to every type
+template<typename List, template<typename> class Trait>
+struct transform;
+
+template<typename... Ts, template<typename> class Trait>
+struct transform<type_list<Ts...>, Trait> {
+    using type = type_list<typename Trait<Ts>::type...>;
+};
+
+template<typename List, template<typename> class Trait>
+using transform_t = typename transform<List, Trait>::type;
+
+// rebind: instantiates a variadic template with the types of a list
+template<typename List, template<typename...> class Into>
+struct rebind;
+
+template<typename... Ts, template<typename...> class Into>
+struct rebind<type_list<Ts...>, Into> {
+    using type = Into<Ts...>;
+};
+
+template<typename List, template<typename...> class Into>
+using rebind_t = typename rebind<List, Into>::type;
+
+}
+#endif
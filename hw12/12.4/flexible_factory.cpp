@@ -1,7 +1,11 @@
 #include "flexible_factory.h"
+#include "prototype_factory.h"
+#include "train_manifest.h"
+#include <filesystem>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <unistd.h>
 
 using namespace std;
 using namespace cspp51045;
@@ -101,21 +105,43 @@ public:
 };
 
 // Define the abstract factory type with constructor signatures
-using TrainFactory = flexible_abstract_factory
+using TrainFactory = flexible_abstract_factory<
     Locomotive(double), 
     FreightCar(long),
     Caboose
 >;
 
 // Define concrete factories
-using ModelTrainFactory = flexible_concrete_factory
+using ModelTrainFactory = flexible_concrete_factory<
     TrainFactory, 
     ModelLocomotive, 
     ModelFreightCar, 
     ModelCaboose
 >;
 
-using RealTrainFactory = flexible_concrete_factory
+using RealTrainFactory = flexible_concrete_factory<
+    TrainFactory, 
+    RealLocomotive, 
+    RealFreightCar, 
+    RealCaboose
+>;
+
+// The same families built on a flat creator table
+using FlatTrainFactory = flat_flexible_abstract_factory<
+    Locomotive(double), 
+    FreightCar(long),
+    Caboose
+>;
+
+using FlatRealTrainFactory = flat_flexible_concrete_factory<
+    FlatTrainFactory, 
+    RealLocomotive, 
+    RealFreightCar, 
+    RealCaboose
+>;
+
+// Stamps out copies of preconfigured real train cars
+using RealPrototypeFactory = flexible_prototype_factory<
     TrainFactory, 
     RealLocomotive, 
     RealFreightCar, 
@@ -151,5 +177,53 @@ int main() {
     freightCar->display();
     caboose->display();
     
+    // Flat factories are used the same way
+    unique_ptr<FlatTrainFactory> flatFactory = make_unique<FlatRealTrainFactory>();
+    locomotive = flatFactory->create<Locomotive>(4400.0);
+    freightCar = flatFactory->create<FreightCar>(30000L);
+    caboose = flatFactory->create<Caboose>();
+    
+    cout << "\nReal Train Components (flat factory):" << endl;
+    locomotive->display();
+    freightCar->display();
+    caboose->display();
+    
+    // Prototype factories copy their prototypes instead of constructing
+    RealPrototypeFactory prototypeFactory(RealLocomotive(4400.0), RealFreightCar(30000L), RealCaboose());
+    locomotive = prototypeFactory.clone<Locomotive>();
+    auto freightCars = prototypeFactory.clone_n<FreightCar>(1000);
+    caboose = prototypeFactory.clone<Caboose>();
+    
+    cout << "\nReal Train Components (prototype factory, " << freightCars.size()
+         << " freight cars):" << endl;
+    locomotive->display();
+    freightCars[0].display();
+    freightCars[freightCars.size() - 1].display();
+    caboose->display();
+    
+    // A train written to a manifest once and rebuilt from it on demand.
+    // The file goes in the temporary directory and is removed at the end.
+    const string manifestPath = (filesystem::temp_directory_path()
+        / ("real_train." + to_string(::getpid()) + ".manifest")).string();
+    {
+        train_manifest<TrainFactory>::writer out(manifestPath);
+        out.add<Locomotive>(4400.0);
+        for (long i = 0; i < 1000; ++i) {
+            out.add<FreightCar>(30000L + i);
+        }
+        out.add<Caboose>();
+    }
+    train_manifest<TrainFactory> manifest(manifestPath);
+    RealTrainFactory realFactory;
+    lazy_train<TrainFactory> train(manifest, realFactory);
+    
+    cout << "\nReal Train Components (manifest of " << train.size() << " cars):" << endl;
+    train.get<Locomotive>(0).display();
+    train.get<FreightCar>(500).display();
+    train.get<Caboose>(train.size() - 1).display();
+    cout << train.created_count() << " cars created" << endl;
+    // Still mapped, so the train stays usable until it goes out of scope
+    filesystem::remove(manifestPath);
+    
     return 0;
 }
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include <memory>
 #include <type_traits>
 #include <functional>
+#include "../12.1/traits.h"
+#include "../12.3/thread_cache.h"
+#include "../12.3/type_list.h"
 
 namespace cspp51045 {
 
@@ -14,16 +17,11 @@ struct TTS {
     using args = std::tuple<Args...>;
 };
 
-// Helper to extract type from a function signature
+// Helper to extract type from a function signature: return_type,
+// args_tuple, arg_count, arg_t<I> and the rest of function_traits, for
+// plain, noexcept and pointer-to-function signatures alike
 template<typename T>
-struct signature_trait;
-
-// Specialization for function types
-template<typename R, typename... Args>
-struct signature_trait<R(Args...)> {
-    using return_type = R;
-    using args_tuple = std::tuple<Args...>;
-    static constexpr size_t arg_count = sizeof...(Args);
+struct signature_trait : function_traits<T> {
 };
 
 // Add this helper to determine if a type is a function signature
@@ -36,47 +34,70 @@ struct is_signature<R(Args...)> : std::true_type {};
 template<typename T>
 inline constexpr bool is_signature_v = is_signature<T>::value;
 
+// Helper type trait to determine which concrete creator to use
+template<typename T>
+struct factory_trait {
+    using type = T;
+    static constexpr bool has_params = false;
+};
+
+template<typename R, typename... Args>
+struct factory_trait<R(Args...)> {
+    using type = R;
+    static constexpr bool has_params = true;
+    using signature = R(Args...);
+};
+
+// Finds the entry in Types... (a plain type or a signature) that creates U,
+// or void if there is none. One flat lookup in the list of product types,
+// so the cost does not grow with U's position in Types...
+template<typename U, typename... Types>
+struct find_signature {
+    using type = type_at_t<index_of_v<U, type_list<typename factory_trait<Types>::type...>>,
+                           type_list<Types..., void>>;
+};
+
+template<typename U, typename... Types>
+using find_signature_t = typename find_signature<U, Types...>::type;
+
 // Modified flexible abstract creator
 template<typename T, typename Enable = void>
 struct flexible_abstract_creator;
 
 // Specialization for function signatures
-template<typename Signature>
-struct flexible_abstract_creator<Signature, 
-    std::enable_if_t<is_signature_v<Signature>>> {
-    using T = typename signature_trait<Signature>::return_type;
-    using ArgsT = typename signature_trait<Signature>::args_tuple;
-    
-    template<typename... Args>
-    virtual std::unique_ptr<T> doCreate(TTS<T, Args...>&&, Args&&... args) = 0;
+// Virtual functions cannot be templates, so the argument list is fixed by
+// the signature and callers' arguments are converted to it.
+template<typename R, typename... Args>
+struct flexible_abstract_creator<R(Args...)> {
+    using T = R;
+    using ArgsT = std::tuple<Args...>;
+    using tag_type = TTS<R, Args...>;
+
+    virtual std::unique_ptr<T> doCreate(tag_type&&, Args... args) = 0;
 };
 
 // Specialization for non-function types (default constructor case)
 template<typename T>
 struct flexible_abstract_creator<T, 
     std::enable_if_t<!is_signature_v<T>>> {
-    virtual std::unique_ptr<T> doCreate(TTS<T>&&) = 0;
+    using tag_type = TTS<T>;
+
+    virtual std::unique_ptr<T> doCreate(tag_type&&) = 0;
 };
 
 // The flexible abstract factory
+// A concrete factory holds no state, so one instance may be shared by any
+// number of threads calling create() concurrently. Products come from the
+// global heap; see thread_cached_flexible_factory to avoid contending there.
 template<typename... Types>
 struct flexible_abstract_factory : public flexible_abstract_creator<Types>... {
-    // Helper for parameterized constructor case
-    template<typename U, typename... Args, 
-             std::enable_if_t<is_signature_v<U(Args...)>, int> = 0>
-    std::unique_ptr<typename signature_trait<U(Args...)>::return_type> 
-    create(Args&&... args) {
-        using ReturnType = typename signature_trait<U(Args...)>::return_type;
-        flexible_abstract_creator<U(Args...)>& creator = *this;
-        return creator.doCreate(TTS<ReturnType, Args...>(), std::forward<Args>(args)...);
-    }
-    
-    // Helper for default constructor case
-    template<typename U, 
-             std::enable_if_t<!is_signature_v<U>, int> = 0>
-    std::unique_ptr<U> create() {
-        flexible_abstract_creator<U>& creator = *this;
-        return creator.doCreate(TTS<U>());
+    template<typename U, typename... Args>
+    std::unique_ptr<U> create(Args&&... args) {
+        using Signature = find_signature_t<U, Types...>;
+        static_assert(!std::is_void_v<Signature>, "U is not a product of this factory");
+        flexible_abstract_creator<Signature>& creator = *this;
+        return creator.doCreate(typename flexible_abstract_creator<Signature>::tag_type(),
+                                std::forward<Args>(args)...);
     }
     
     virtual ~flexible_abstract_factory() = default;
@@ -97,25 +118,11 @@ struct flexible_concrete_creator_param;
 template<typename AbstractFactory, typename Abstract, typename... Args, typename Concrete>
 struct flexible_concrete_creator_param<AbstractFactory, Abstract(Args...), Concrete> 
     : virtual public AbstractFactory {
-    std::unique_ptr<Abstract> doCreate(TTS<Abstract, Args...>&&, Args&&... args) override {
+    std::unique_ptr<Abstract> doCreate(TTS<Abstract, Args...>&&, Args... args) override {
         return std::make_unique<Concrete>(std::forward<Args>(args)...);
     }
 };
 
-// Helper type trait to determine which concrete creator to use
-template<typename T>
-struct factory_trait {
-    using type = T;
-    static constexpr bool has_params = false;
-};
-
-template<typename R, typename... Args>
-struct factory_trait<R(Args...)> {
-    using type = R;
-    static constexpr bool has_params = true;
-    using signature = R(Args...);
-};
-
 // Concrete factory helper
 template<typename AbstractFactory, typename... ConcreteTypes>
 struct flexible_concrete_factory;
@@ -123,7 +130,7 @@ struct flexible_concrete_factory;
 // Implementation of concrete factory
 template<typename... AbstractTypes, typename... ConcreteTypes>
 struct flexible_concrete_factory<flexible_abstract_factory<AbstractTypes...>, ConcreteTypes...> 
-    : public std::conditional_t
+    : public std::conditional_t<
         factory_trait<AbstractTypes>::has_params,
         flexible_concrete_creator_param<flexible_abstract_factory<AbstractTypes...>, 
                                        AbstractTypes, 
@@ -134,5 +141,83 @@ struct flexible_concrete_factory<flexible_abstract_factory<AbstractTypes...>, Co
     >... 
 {};
 
+// Thread-safe creation mode: each product is allocated from the creating
+// thread's block cache (see thread_cache.h), so many threads can share one
+// factory without serializing in the global allocator.
+template<typename AbstractFactory, typename... ConcreteTypes>
+using thread_cached_flexible_factory
+    = flexible_concrete_factory<AbstractFactory, thread_cached<ConcreteTypes>...>;
+
+// Flat flexible factory: one table of creator functions instead of one
+// creator base class per product (see flat_abstract_factory in
+// ../12.3/flat_factory.h). So that creators of every signature fit in one
+// table, each takes a pointer to a tuple holding its arguments.
+template<typename T>
+struct flat_creator_trait {
+    using args_tuple = std::tuple<>;
+
+    template<typename Concrete>
+    static void* make(void*) {
+        return static_cast<T*>(new Concrete());
+    }
+};
+
+template<typename R, typename... Args>
+struct flat_creator_trait<R(Args...)> {
+    using args_tuple = std::tuple<Args...>;
+
+    template<typename Concrete>
+    static void* make(void* args) {
+        return std::apply([](Args&... a) {
+            return static_cast<R*>(new Concrete(std::forward<Args>(a)...));
+        }, *static_cast<args_tuple*>(args));
+    }
+};
+
+template<typename... Types>
+class flat_flexible_abstract_factory {
+public:
+    template<typename U, typename... Args>
+    std::unique_ptr<U> create(Args&&... args) const {
+        constexpr std::size_t index
+            = index_of_v<U, type_list<typename factory_trait<Types>::type...>>;
+        static_assert(index < sizeof...(Types), "U is not a product of this factory");
+        // Converted to the signature's parameter types, as doCreate would
+        typename flat_creator_trait<type_at_t<index, type_list<Types...>>>::args_tuple
+            packed(std::forward<Args>(args)...);
+        return std::unique_ptr<U>(static_cast<U*>(creators_[index](&packed)));
+    }
+
+    virtual ~flat_flexible_abstract_factory() = default;
+
+protected:
+    using creator = void* (*)(void*);
+
+    explicit flat_flexible_abstract_factory(const creator* creators) : creators_(creators) {}
+
+private:
+    const creator* creators_;
+};
+
+template<typename AbstractFactory, typename... ConcreteTypes>
+struct flat_flexible_concrete_factory;
+
+template<typename... AbstractTypes, typename... ConcreteTypes>
+struct flat_flexible_concrete_factory<flat_flexible_abstract_factory<AbstractTypes...>,
+                                      ConcreteTypes...>
+    : public flat_flexible_abstract_factory<AbstractTypes...> {
+    static_assert(sizeof...(AbstractTypes) == sizeof...(ConcreteTypes),
+                  "one concrete type per product");
+
+    flat_flexible_concrete_factory()
+        : flat_flexible_abstract_factory<AbstractTypes...>(creators) {}
+
+private:
+    using creator = typename flat_flexible_abstract_factory<AbstractTypes...>::creator;
+
+    static constexpr creator creators[] = {
+        &flat_creator_trait<AbstractTypes>::template make<ConcreteTypes>...};
+};
+
 } // namespace cspp51045
 #endif
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "train_manifest.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace std;
+using namespace cspp51045;
+
+// Rebuilds a long train at "process start" three ways: one create<>() per
+// car with the composition in code, create_all from a mapped manifest,
+// and a lazy_train over the manifest that creates only the cars used.
+//
+//     manifest_benchmark [cars] [manifest path]
+
+struct Locomotive {
+    virtual double getHorsepower() const = 0;
+    virtual ~Locomotive() = default;
+};
+
+struct FreightCar {
+    virtual long getCapacity() const = 0;
+    virtual ~FreightCar() = default;
+};
+
+struct Caboose {
+    virtual ~Caboose() = default;
+};
+
+class RealLocomotive : public Locomotive {
+    double horsepower;
+public:
+    RealLocomotive(double hp) : horsepower(hp) {}
+    double getHorsepower() const override { return horsepower; }
+};
+
+class RealFreightCar : public FreightCar {
+    long capacity;
+public:
+    RealFreightCar(long cap) : capacity(cap) {}
+    long getCapacity() const override { return capacity; }
+};
+
+class RealCaboose : public Caboose {};
+
+using TrainFactory = flexible_abstract_factory<Locomotive(double), FreightCar(long), Caboose>;
+using RealTrainFactory = flexible_concrete_factory<TrainFactory, RealLocomotive, RealFreightCar, RealCaboose>;
+using TrainManifest = train_manifest<TrainFactory>;
+
+// Car i of the benchmark train: a locomotive every 100 cars, a caboose last
+int kind_of(size_t i, size_t count) {
+    return i + 1 == count ? 2 : i % 100 == 0 ? 0 : 1;
+}
+
+double car_value(const TrainManifest::car& car) {
+    return visit([](auto& p) -> double {
+        using product = typename decay_t<decltype(p)>::element_type;
+        if constexpr (is_same_v<product, Locomotive>) {
+            return p->getHorsepower();
+        } else if constexpr (is_same_v<product, FreightCar>) {
+            return static_cast<double>(p->getCapacity());
+        } else {
+            return 1;
+        }
+    }, car);
+}
+
+// A manifest whose record names a product the factory does not have must
+// be refused, not used to index the factory's tables
+bool check_corrupt_manifest(const string& path, RealTrainFactory& factory) {
+    {
+        TrainManifest::writer out(path);
+        out.add<Locomotive>(4000.0);
+        out.add<FreightCar>(1000L);
+    }
+    {
+        // Record 1's product index: after the header, the three product
+        // sizes padded to four, and record 0
+        fstream file(path, ios::binary | ios::in | ios::out);
+        file.seekp(static_cast<streamoff>(sizeof(manifest_header) + 4 * sizeof(uint32_t)
+                                          + TrainManifest::record_stride));
+        uint32_t bad = 1000000;
+        file.write(reinterpret_cast<const char*>(&bad), sizeof(bad));
+    }
+    TrainManifest manifest(path);
+    int refused = 0;
+    try {
+        manifest.create_all(factory);
+    } catch (runtime_error&) {
+        ++refused;
+    }
+    try {
+        lazy_train<TrainFactory> train(manifest, factory);
+        train.get<FreightCar>(1);
+    } catch (runtime_error&) {
+        ++refused;
+    }
+    remove(path.c_str());
+    if (refused != 2) {
+        cerr << "Corrupt manifest was used" << endl;
+        return false;
+    }
+    return true;
+}
+
+template<typename Func>
+double time_run(Func run, double& checksum, const string& name) {
+    auto start = chrono::high_resolution_clock::now();
+    checksum = run();
+    auto end = chrono::high_resolution_clock::now();
+
+    chrono::duration<double, milli> duration = end - start;
+    cout << "  " << name << " took " << duration.count() << " ms" << endl;
+    return duration.count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? stoul(argv[1]) : 2000000;
+    string path = argc > 2 ? argv[2] : "train.manifest";
+    RealTrainFactory factory;
+
+    {
+        TrainManifest::writer out(path);
+        for (size_t i = 0; i < count; ++i) {
+            switch (kind_of(i, count)) {
+            case 0: out.add<Locomotive>(4000.0 + static_cast<double>(i % 7)); break;
+            case 1: out.add<FreightCar>(static_cast<long>(1000 + i)); break;
+            default: out.add<Caboose>(); break;
+            }
+        }
+    }
+
+    double codeSum = 0, bulkSum = 0, lazySum = 0, touchedSum = 0;
+    const size_t touched = 1000;
+    cout << "Rebuilding a train of " << count << " cars:" << endl;
+    time_run([&]() {
+        vector<TrainManifest::car> cars;
+        cars.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            switch (kind_of(i, count)) {
+            case 0: cars.push_back(factory.create<Locomotive>(4000.0 + static_cast<double>(i % 7))); break;
+            case 1: cars.push_back(factory.create<FreightCar>(static_cast<long>(1000 + i))); break;
+            default: cars.push_back(factory.create<Caboose>()); break;
+            }
+        }
+        double sum = 0;
+        for (auto& car : cars) sum += car_value(car);
+        return sum;
+    }, codeSum, "create in code");
+    time_run([&]() {
+        TrainManifest manifest(path);
+        vector<TrainManifest::car> cars = manifest.create_all(factory);
+        double sum = 0;
+        for (auto& car : cars) sum += car_value(car);
+        return sum;
+    }, bulkSum, "manifest create_all");
+    time_run([&]() {
+        TrainManifest manifest(path);
+        lazy_train<TrainFactory> train(manifest, factory);
+        return static_cast<double>(train.size());
+    }, lazySum, "lazy_train startup");
+    time_run([&]() {
+        TrainManifest manifest(path);
+        lazy_train<TrainFactory> train(manifest, factory);
+        double sum = 0;
+        for (size_t k = 0; k < touched; ++k) {
+            size_t i = k * (count / touched) + 1;
+            if (manifest.holds<FreightCar>(i)) {
+                sum += static_cast<double>(train.get<FreightCar>(i).getCapacity());
+            }
+        }
+        return sum;
+    }, touchedSum, "lazy_train startup + " + to_string(touched) + " cars used");
+
+    if (codeSum != bulkSum || lazySum != static_cast<double>(count)) {
+        cerr << "Trains differ" << endl;
+        return 1;
+    }
+    return check_corrupt_manifest(path + ".corrupt", factory) ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include "prototype_factory.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cspp51045;
+
+// Creates many identical cars three ways and compares them: one create<>()
+// per car, one clone<>() of a prototype per car, and one clone_n<>() for
+// all of them. Freight cars announce themselves in their constructor like
+// the cars in ../12.5/patameterized.cpp (into a string stream here, so the
+// terminal does not dominate the timings). Couplers are trivially copyable,
+// so clone_n copies them as bytes.
+//
+//     prototype_benchmark [count]
+
+ostringstream constructionLog;
+
+struct FreightCar {
+    virtual long getCapacity() const = 0;
+    virtual ~FreightCar() = default;
+};
+
+class LoggedFreightCar : public FreightCar {
+    long capacity;
+public:
+    LoggedFreightCar(long cap) : capacity(cap) {
+        constructionLog << "Creating real freight car with " << cap << " capacity\n";
+    }
+    long getCapacity() const override { return capacity; }
+};
+
+// Derived ratings are worked out once, in the constructor
+struct Coupler {
+    double strength;
+    double workingLoad;
+    double proofLoad;
+    unsigned long serial;
+
+    Coupler(double s) : strength(s), workingLoad(s / 2.5), proofLoad(s / 1.25), serial(0) {
+        for (int i = 0; i < 16; ++i) {
+            serial = serial * 31 + static_cast<unsigned long>(strength * (i + 1)) % 97;
+        }
+    }
+};
+
+using CarFactory = flexible_abstract_factory<FreightCar(long), Coupler(double)>;
+using RealCarFactory = flexible_prototype_factory<CarFactory, LoggedFreightCar, Coupler>;
+
+template<typename Func>
+double time_run(Func run, double& checksum, const string& name) {
+    constructionLog.str("");
+    auto start = chrono::high_resolution_clock::now();
+    checksum = run();
+    auto end = chrono::high_resolution_clock::now();
+
+    chrono::duration<double, milli> duration = end - start;
+    cout << "  " << name << " took " << duration.count() << " ms" << endl;
+    return duration.count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? stoul(argv[1]) : 1000000;
+    RealCarFactory factory(LoggedFreightCar(50000L), Coupler(1200.0));
+    CarFactory& abstractFactory = factory;
+    double createSum = 0, cloneSum = 0, pooledSum = 0;
+
+    cout << "Creating " << count << " freight cars:" << endl;
+    double createMs = time_run([&]() {
+        vector<unique_ptr<FreightCar>> cars;
+        cars.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            cars.push_back(abstractFactory.create<FreightCar>(50000L));
+        }
+        double sum = 0;
+        for (auto& car : cars) sum += static_cast<double>(car->getCapacity());
+        return sum;
+    }, createSum, "create each");
+    time_run([&]() {
+        vector<unique_ptr<FreightCar>> cars;
+        cars.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            cars.push_back(factory.clone<FreightCar>());
+        }
+        double sum = 0;
+        for (auto& car : cars) sum += static_cast<double>(car->getCapacity());
+        return sum;
+    }, cloneSum, "clone each");
+    double pooledMs = time_run([&]() {
+        auto cars = factory.clone_n<FreightCar>(count);
+        double sum = 0;
+        for (FreightCar& car : cars) sum += static_cast<double>(car.getCapacity());
+        return sum;
+    }, pooledSum, "clone_n");
+    cout << "  clone_n speedup over create: " << createMs / pooledMs << "x" << endl;
+    if (createSum != cloneSum || createSum != pooledSum) {
+        cerr << "Checksums differ" << endl;
+        return 1;
+    }
+
+    cout << "Creating " << count << " couplers (trivially copyable):" << endl;
+    createMs = time_run([&]() {
+        vector<unique_ptr<Coupler>> couplers;
+        couplers.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            couplers.push_back(abstractFactory.create<Coupler>(1200.0));
+        }
+        double sum = 0;
+        for (auto& c : couplers) sum += c->workingLoad + static_cast<double>(c->serial % 1000);
+        return sum;
+    }, createSum, "create each");
+    time_run([&]() {
+        vector<unique_ptr<Coupler>> couplers;
+        couplers.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            couplers.push_back(factory.clone<Coupler>());
+        }
+        double sum = 0;
+        for (auto& c : couplers) sum += c->workingLoad + static_cast<double>(c->serial % 1000);
+        return sum;
+    }, cloneSum, "clone each");
+    pooledMs = time_run([&]() {
+        auto couplers = factory.clone_n<Coupler>(count);
+        double sum = 0;
+        for (Coupler& c : couplers) sum += c.workingLoad + static_cast<double>(c.serial % 1000);
+        return sum;
+    }, pooledSum, "clone_n");
+    cout << "  clone_n speedup over create: " << createMs / pooledMs << "x" << endl;
+    if (createSum != cloneSum || createSum != pooledSum) {
+        cerr << "Checksums differ" << endl;
+        return 1;
+    }
+    return 0;
+}
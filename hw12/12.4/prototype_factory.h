@@ -0,0 +1,196 @@
+#ifndef PROTOTYPE_FACTORY_H
+#define PROTOTYPE_FACTORY_H
+#include "flexible_factory.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace cspp51045 {
+
+// n products stamped from one prototype, in one block of memory and owned
+// as a group. Accessed through their abstract type U.
+template<typename U>
+class pooled_products {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = U;
+        using difference_type = std::ptrdiff_t;
+        using pointer = U*;
+        using reference = U&;
+
+        iterator() = default;
+        U& operator*() const { return *pool_->upcast_(pool_->slot(i_)); }
+        U* operator->() const { return &**this; }
+        iterator& operator++() { ++i_; return *this; }
+        iterator operator++(int) { iterator old = *this; ++i_; return old; }
+        bool operator==(const iterator& other) const { return i_ == other.i_; }
+
+    private:
+        friend class pooled_products;
+        iterator(const pooled_products* pool, std::size_t i) : pool_(pool), i_(i) {}
+        const pooled_products* pool_ = nullptr;
+        std::size_t i_ = 0;
+    };
+
+    pooled_products(pooled_products&& other) noexcept
+        : storage_(std::exchange(other.storage_, nullptr)), count_(std::exchange(other.count_, 0)),
+          stride_(other.stride_), align_(other.align_), upcast_(other.upcast_), destroy_(other.destroy_) {}
+
+    pooled_products& operator=(pooled_products&& other) noexcept {
+        if (this != &other) {
+            release();
+            storage_ = std::exchange(other.storage_, nullptr);
+            count_ = std::exchange(other.count_, 0);
+            stride_ = other.stride_;
+            align_ = other.align_;
+            upcast_ = other.upcast_;
+            destroy_ = other.destroy_;
+        }
+        return *this;
+    }
+
+    ~pooled_products() { release(); }
+
+    // n copies of prototype in one block of fresh storage. A trivially
+    // copyable prototype is copied as bytes: once, and then by doubling the
+    // filled prefix, so n copies take about log n memcpy calls. Anything
+    // else is copy constructed, which still never runs the product's own
+    // constructor logic.
+    template<typename Concrete>
+    static pooled_products stamp(const Concrete& prototype, std::size_t n) {
+        static_assert(std::is_convertible_v<Concrete*, U*>, "prototype must be a U");
+        constexpr std::size_t stride = sizeof(Concrete);
+        constexpr std::size_t align = alignof(Concrete);
+        auto* storage = static_cast<std::byte*>(
+            ::operator new(std::max<std::size_t>(n, 1) * stride, std::align_val_t{align}));
+        if constexpr (std::is_trivially_copyable_v<Concrete>) {
+            if (n > 0) {
+                std::memcpy(storage, &prototype, stride);
+            }
+            for (std::size_t done = 1; done < n;) {
+                std::size_t chunk = std::min(done, n - done);
+                std::memcpy(storage + done * stride, storage, chunk * stride);
+                done += chunk;
+            }
+        } else {
+            try {
+                std::uninitialized_fill_n(reinterpret_cast<Concrete*>(storage), n, prototype);
+            } catch (...) {
+                ::operator delete(storage, std::align_val_t{align});
+                throw;
+            }
+        }
+        return pooled_products(
+            storage, n, stride, align,
+            [](std::byte* p) -> U* { return std::launder(reinterpret_cast<Concrete*>(p)); },
+            [](std::byte* p, std::size_t count) {
+                if constexpr (!std::is_trivially_destructible_v<Concrete>) {
+                    std::destroy_n(std::launder(reinterpret_cast<Concrete*>(p)), count);
+                }
+            });
+    }
+
+    std::size_t size() const { return count_; }
+    U& operator[](std::size_t i) const { return *upcast_(slot(i)); }
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, count_); }
+
+private:
+    using upcast_fn = U* (*)(std::byte*);
+    using destroy_fn = void (*)(std::byte*, std::size_t);
+
+    pooled_products(std::byte* storage, std::size_t count, std::size_t stride, std::size_t align,
+                    upcast_fn upcast, destroy_fn destroy)
+        : storage_(storage), count_(count), stride_(stride), align_(align), upcast_(upcast),
+          destroy_(destroy) {}
+
+    std::byte* slot(std::size_t i) const { return storage_ + i * stride_; }
+
+    void release() noexcept {
+        if (storage_) {
+            destroy_(storage_, count_);
+            ::operator delete(storage_, std::align_val_t{align_});
+            storage_ = nullptr;
+        }
+    }
+
+    std::byte* storage_;
+    std::size_t count_;
+    std::size_t stride_;
+    std::size_t align_;
+    upcast_fn upcast_;
+    destroy_fn destroy_;
+};
+
+// Prototype creation mode: besides creating products from constructor
+// arguments like any flexible_concrete_factory, the factory holds one
+// preconfigured instance of every concrete product and stamps out copies
+// of it. Only the prototypes ever run their constructors, so mass
+// creation of identical products skips per-object constructor logic.
+//     RealPrototypeFactory factory(RealLocomotive(5000.0), RealFreightCar(50000L), RealCaboose());
+//     auto car = factory.clone<FreightCar>();             // one copy on the heap
+//     auto cars = factory.clone_n<FreightCar>(10000);    // 10000 copies, one allocation
+// Prototypes are read-only while cloning, so clone and clone_n may be
+// called concurrently; configure may not run alongside them.
+template<typename AbstractFactory, typename... ConcreteTypes>
+class flexible_prototype_factory;
+
+template<typename... AbstractTypes, typename... ConcreteTypes>
+class flexible_prototype_factory<flexible_abstract_factory<AbstractTypes...>, ConcreteTypes...>
+    : public flexible_concrete_factory<flexible_abstract_factory<AbstractTypes...>, ConcreteTypes...> {
+    static_assert(sizeof...(AbstractTypes) == sizeof...(ConcreteTypes),
+                  "one concrete type per product");
+    static_assert((std::is_copy_constructible_v<ConcreteTypes> && ...),
+                  "prototypes are copied, so concrete products must be copy constructible");
+
+    template<typename U>
+    static constexpr std::size_t index
+        = index_of_v<U, type_list<typename factory_trait<AbstractTypes>::type...>>;
+
+    template<typename U>
+    using concrete_t = type_at_t<index<U>, type_list<ConcreteTypes...>>;
+
+public:
+    // Prototypes in the order of the factory's products
+    explicit flexible_prototype_factory(ConcreteTypes... prototypes)
+        : prototypes_(std::move(prototypes)...) {}
+
+    // Replaces U's prototype with one constructed from args
+    template<typename U, typename... Args>
+    void configure(Args&&... args) {
+        static_assert(index<U> < sizeof...(AbstractTypes), "U is not a product of this factory");
+        std::get<index<U>>(prototypes_) = concrete_t<U>(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    const concrete_t<U>& prototype() const {
+        static_assert(index<U> < sizeof...(AbstractTypes), "U is not a product of this factory");
+        return std::get<index<U>>(prototypes_);
+    }
+
+    // A copy of U's prototype
+    template<typename U>
+    std::unique_ptr<U> clone() const {
+        return std::make_unique<concrete_t<U>>(prototype<U>());
+    }
+
+    // n copies of U's prototype in one pooled allocation
+    template<typename U>
+    pooled_products<U> clone_n(std::size_t n) const {
+        return pooled_products<U>::stamp(prototype<U>(), n);
+    }
+
+private:
+    std::tuple<ConcreteTypes...> prototypes_;
+};
+
+} // namespace cspp51045
+#endif
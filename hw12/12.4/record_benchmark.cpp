@@ -0,0 +1,138 @@
+#include "record_factory.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cspp51045;
+
+// Builds trains from log lines such as "Locomotive 120.5", once with
+// static_regex patterns feeding create_from_record and once with
+// precompiled std::regex objects, and compares the two. Then checks that
+// a record far longer than any real one still matches (or fails to)
+// without exhausting the stack.
+
+struct Locomotive {
+    virtual double getHorsepower() const = 0;
+    virtual ~Locomotive() = default;
+};
+
+struct FreightCar {
+    virtual long getCapacity() const = 0;
+    virtual ~FreightCar() = default;
+};
+
+struct Caboose {
+    virtual ~Caboose() = default;
+};
+
+class ModelLocomotive : public Locomotive {
+    double horsepower;
+public:
+    ModelLocomotive(double hp) : horsepower(hp) {}
+    double getHorsepower() const override { return horsepower; }
+};
+
+class ModelFreightCar : public FreightCar {
+    long capacity;
+public:
+    ModelFreightCar(long cap) : capacity(cap) {}
+    long getCapacity() const override { return capacity; }
+};
+
+class ModelCaboose : public Caboose {};
+
+using TrainFactory = flexible_abstract_factory<Locomotive(double), FreightCar(long), Caboose>;
+using ModelTrainFactory = flexible_concrete_factory<TrainFactory, ModelLocomotive, ModelFreightCar, ModelCaboose>;
+
+struct Train {
+    vector<unique_ptr<Locomotive>> locomotives;
+    vector<unique_ptr<FreightCar>> freightCars;
+    vector<unique_ptr<Caboose>> cabooses;
+
+    double checksum() const {
+        double sum = static_cast<double>(cabooses.size());
+        for (auto& l : locomotives) sum += l->getHorsepower();
+        for (auto& f : freightCars) sum += static_cast<double>(f->getCapacity());
+        return sum;
+    }
+};
+
+Train build_static(TrainFactory& factory, const vector<string>& lines) {
+    Train train;
+    for (const string& line : lines) {
+        if (auto loco = create_from_record<"Locomotive (\\d+(?:\\.\\d+)?)", Locomotive>(factory, line)) {
+            train.locomotives.push_back(std::move(loco));
+        } else if (auto car = create_from_record<"FreightCar (\\d+)", FreightCar>(factory, line)) {
+            train.freightCars.push_back(std::move(car));
+        } else if (auto caboose = create_from_record<"Caboose", Caboose>(factory, line)) {
+            train.cabooses.push_back(std::move(caboose));
+        }
+    }
+    return train;
+}
+
+Train build_std_regex(TrainFactory& factory, const vector<string>& lines) {
+    static const regex locoPattern("Locomotive (\\d+(?:\\.\\d+)?)");
+    static const regex carPattern("FreightCar (\\d+)");
+    static const regex caboosePattern("Caboose");
+    Train train;
+    smatch m;
+    for (const string& line : lines) {
+        if (regex_match(line, m, locoPattern)) {
+            train.locomotives.push_back(factory.create<Locomotive>(stod(m[1].str())));
+        } else if (regex_match(line, m, carPattern)) {
+            train.freightCars.push_back(factory.create<FreightCar>(stol(m[1].str())));
+        } else if (regex_match(line, m, caboosePattern)) {
+            train.cabooses.push_back(factory.create<Caboose>());
+        }
+    }
+    return train;
+}
+
+template<typename Func>
+double time_build(Func build, double& checksum, const string& name) {
+    auto start = chrono::high_resolution_clock::now();
+    Train train = build();
+    auto end = chrono::high_resolution_clock::now();
+    checksum = train.checksum();
+
+    chrono::duration<double, milli> duration = end - start;
+    cout << name << " took " << duration.count() << " ms" << endl;
+    return duration.count();
+}
+
+// A greedy loop over 200000 digits, matched and then not matched
+bool check_long_record() {
+    string digits(200000, '7');
+    string record = "Locomotive " + digits;
+    auto matched = static_regex<"Locomotive (\\d+)">::match(record);
+    bool ok = matched && (*matched)[1] == digits;
+    ok = ok && !static_regex<"Locomotive (\\d+)">::match("Locomotive " + digits + "x");
+    cout << "200000-digit record: " << (ok ? "handled" : "MISMATCHED") << endl;
+    return ok;
+}
+
+int main() {
+    const int SIZE = 300000;
+    vector<string> lines;
+    for (int i = 0; i < SIZE; ++i) {
+        switch (i % 10) {
+        case 0: lines.push_back("Locomotive " + to_string(100 + i % 900) + ".5"); break;
+        case 9: lines.push_back("Caboose"); break;
+        default: lines.push_back("FreightCar " + to_string(1000 + i)); break;
+        }
+    }
+
+    ModelTrainFactory factory;
+    double staticSum = 0, stdSum = 0;
+    cout << "Building a train from " << SIZE << " records:" << endl;
+    double staticMs = time_build([&]() { return build_static(factory, lines); }, staticSum, "static_regex");
+    double stdMs = time_build([&]() { return build_std_regex(factory, lines); }, stdSum, "std::regex");
+    cout << "speedup: " << stdMs / staticMs << "x, trains "
+         << (staticSum == stdSum ? "identical" : "DIFFER") << endl;
+    return check_long_record() ? 0 : 1;
+}
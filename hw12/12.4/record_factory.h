@@ -0,0 +1,44 @@
+#ifndef RECORD_FACTORY_H
+#define RECORD_FACTORY_H
+#include "flexible_factory.h"
+#include "static_regex.h"
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace cspp51045 {
+
+// Constructor arguments a flexible factory entry takes, as a tuple
+template<typename T>
+struct creator_args {
+    using type = std::tuple<>;
+};
+
+template<typename R, typename... Args>
+struct creator_args<R(Args...)> {
+    using type = std::tuple<Args...>;
+};
+
+template<fixed_string Pattern, typename U, typename Factory, typename... Args>
+std::unique_ptr<U> create_from_captures(Factory& factory, std::string_view line, std::tuple<Args...>*) {
+    auto args = match_as<Pattern, std::decay_t<Args>...>(line);
+    if (!args) {
+        return nullptr;
+    }
+    return std::apply([&](auto&... arg) { return factory.template create<U>(arg...); }, *args);
+}
+
+// Parses a record such as "Locomotive 120.5" with a compile-time pattern
+// whose capture groups are U's constructor arguments, in order, and
+// creates U from them. Returns nullptr if the line does not match or a
+// capture does not convert.
+//     create_from_record<"Locomotive (\\d+(?:\\.\\d+)?)", Locomotive>(factory, line)
+template<fixed_string Pattern, typename U, typename... Types>
+std::unique_ptr<U> create_from_record(flexible_abstract_factory<Types...>& factory, std::string_view line) {
+    using Args = typename creator_args<find_signature_t<U, Types...>>::type;
+    return create_from_captures<Pattern, U>(factory, line, static_cast<Args*>(nullptr));
+}
+
+} // namespace cspp51045
+#endif
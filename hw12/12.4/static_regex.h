@@ -0,0 +1,691 @@
+#ifndef STATIC_REGEX_H
+#define STATIC_REGEX_H
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Compile-time regular expressions.
+// static_regex<"pattern"> parses and compiles the pattern during
+// compilation into a small backtracking program held in a constexpr array;
+// a malformed pattern is a compile error and nothing is compiled at run
+// time. Supported syntax: literals, '.', escapes (\d \D \w \W \s \S and
+// escaped metacharacters), classes ([a-z_], [^,]), groups ((...) and
+// (?:...)), alternation '|' and the greedy quantifiers * + ? {n} {n,}
+// {n,m}. match() succeeds only if the pattern matches the whole input.
+
+namespace cspp51045 {
+
+// String literal usable as a template argument
+template<std::size_t N>
+struct fixed_string {
+    char data[N]{};
+
+    constexpr fixed_string(const char (&s)[N]) {
+        for (std::size_t i = 0; i < N; ++i) {
+            data[i] = s[i];
+        }
+    }
+
+    constexpr std::size_t size() const { return N - 1; }
+    constexpr char operator[](std::size_t i) const { return data[i]; }
+};
+
+namespace regex_detail {
+
+struct char_set {
+    std::uint64_t bits[4]{};
+
+    constexpr void set(unsigned char c) { bits[c / 64] |= std::uint64_t(1) << (c % 64); }
+    constexpr bool test(unsigned char c) const { return (bits[c / 64] >> (c % 64)) & 1; }
+
+    constexpr void set_range(unsigned char first, unsigned char last) {
+        for (unsigned c = first; c <= last; ++c) {
+            set(static_cast<unsigned char>(c));
+        }
+    }
+
+    constexpr void merge(const char_set& other) {
+        for (int i = 0; i < 4; ++i) {
+            bits[i] |= other.bits[i];
+        }
+    }
+
+    constexpr void invert() {
+        for (int i = 0; i < 4; ++i) {
+            bits[i] = ~bits[i];
+        }
+    }
+};
+
+enum class op : unsigned char { literal, any, char_class, split, jump, save, match };
+
+// split tries x first, then y; jump goes to x; save stores the position in slot x
+struct instruction {
+    op code = op::match;
+    unsigned char ch = 0;
+    unsigned short x = 0;
+    unsigned short y = 0;
+};
+
+enum class node_kind : unsigned char { literal, any, char_class, concat, alternation, repeat, group, empty };
+
+// Parse tree node; children are linked through first_child/next_sibling
+struct node {
+    node_kind kind = node_kind::empty;
+    unsigned char ch = 0;
+    std::size_t cls = 0;
+    std::size_t min = 0;
+    std::size_t max = 0;
+    std::size_t group = 0;
+    int first_child = -1;
+    int next_sibling = -1;
+    bool nullable = true;
+};
+
+inline constexpr std::size_t unbounded = static_cast<std::size_t>(-1);
+
+constexpr char_set escape_class(char c) {
+    char_set set;
+    switch (c) {
+    case 'd': case 'D':
+        set.set_range('0', '9');
+        break;
+    case 'w': case 'W':
+        set.set_range('a', 'z');
+        set.set_range('A', 'Z');
+        set.set_range('0', '9');
+        set.set('_');
+        break;
+    case 's': case 'S':
+        for (char s : {' ', '\t', '\n', '\r', '\f', '\v'}) {
+            set.set(static_cast<unsigned char>(s));
+        }
+        break;
+    }
+    if (c == 'D' || c == 'W' || c == 'S') {
+        set.invert();
+    }
+    return set;
+}
+
+constexpr bool is_class_escape(char c) {
+    return c == 'd' || c == 'D' || c == 'w' || c == 'W' || c == 's' || c == 'S';
+}
+
+// Recursive-descent parser producing a tree of at most MaxNodes nodes
+template<std::size_t MaxNodes>
+struct parser {
+    std::string_view pattern;
+    std::size_t pos = 0;
+    node nodes[MaxNodes]{};
+    char_set classes[MaxNodes]{};
+    std::size_t node_count = 0;
+    std::size_t class_count = 0;
+    std::size_t group_count = 0;
+    int root = -1;
+
+    constexpr explicit parser(std::string_view p) : pattern(p) {}
+
+    constexpr bool at_end() const { return pos == pattern.size(); }
+    constexpr char peek() const { return pattern[pos]; }
+
+    constexpr int add(node n) {
+        nodes[node_count] = n;
+        return static_cast<int>(node_count++);
+    }
+
+    constexpr void append_child(int parent, int child) {
+        int* link = &nodes[parent].first_child;
+        while (*link != -1) {
+            link = &nodes[*link].next_sibling;
+        }
+        *link = child;
+    }
+
+    constexpr void parse() {
+        root = alternation();
+        if (!at_end()) {
+            throw std::logic_error("static_regex: unbalanced ')'");
+        }
+    }
+
+    // alternation := sequence ('|' sequence)*
+    constexpr int alternation() {
+        int first = sequence();
+        if (at_end() || peek() != '|') {
+            return first;
+        }
+        int alt = add(node{node_kind::alternation});
+        append_child(alt, first);
+        bool nullable = nodes[first].nullable;
+        while (!at_end() && peek() == '|') {
+            ++pos;
+            int branch = sequence();
+            append_child(alt, branch);
+            nullable = nullable || nodes[branch].nullable;
+        }
+        nodes[alt].nullable = nullable;
+        return alt;
+    }
+
+    // sequence := repeat*
+    constexpr int sequence() {
+        int seq = add(node{node_kind::concat});
+        bool nullable = true;
+        while (!at_end() && peek() != '|' && peek() != ')') {
+            int item = repeat();
+            append_child(seq, item);
+            nullable = nullable && nodes[item].nullable;
+        }
+        nodes[seq].nullable = nullable;
+        return seq;
+    }
+
+    constexpr std::size_t number() {
+        if (at_end() || peek() < '0' || peek() > '9') {
+            throw std::logic_error("static_regex: expected a number in {}");
+        }
+        std::size_t n = 0;
+        while (!at_end() && peek() >= '0' && peek() <= '9') {
+            n = n * 10 + static_cast<std::size_t>(peek() - '0');
+            ++pos;
+        }
+        return n;
+    }
+
+    // repeat := atom ('*' | '+' | '?' | '{n}' | '{n,}' | '{n,m}')?
+    constexpr int repeat() {
+        int item = atom();
+        if (at_end()) {
+            return item;
+        }
+        std::size_t min = 0;
+        std::size_t max = 0;
+        switch (peek()) {
+        case '*': min = 0; max = unbounded; ++pos; break;
+        case '+': min = 1; max = unbounded; ++pos; break;
+        case '?': min = 0; max = 1; ++pos; break;
+        case '{':
+            ++pos;
+            min = max = number();
+            if (!at_end() && peek() == ',') {
+                ++pos;
+                max = (!at_end() && peek() == '}') ? unbounded : number();
+            }
+            if (at_end() || peek() != '}') {
+                throw std::logic_error("static_regex: expected '}'");
+            }
+            ++pos;
+            if (max < min) {
+                throw std::logic_error("static_regex: bad repeat bounds");
+            }
+            break;
+        default:
+            return item;
+        }
+        if (max == unbounded && nodes[item].nullable) {
+            // Backtracking would loop forever on an empty iteration
+            throw std::logic_error("static_regex: repeated expression can match empty");
+        }
+        node r{node_kind::repeat};
+        r.min = min;
+        r.max = max;
+        r.nullable = min == 0 || nodes[item].nullable;
+        int rep = add(r);
+        append_child(rep, item);
+        return rep;
+    }
+
+    constexpr int atom() {
+        char c = peek();
+        ++pos;
+        switch (c) {
+        case '(': {
+            node g{node_kind::group};
+            bool capturing = true;
+            if (pos + 1 < pattern.size() && peek() == '?' && pattern[pos + 1] == ':') {
+                pos += 2;
+                capturing = false;
+            }
+            g.group = capturing ? ++group_count : 0;
+            int grp = add(g);
+            int inner = alternation();
+            if (at_end() || peek() != ')') {
+                throw std::logic_error("static_regex: missing ')'");
+            }
+            ++pos;
+            append_child(grp, inner);
+            nodes[grp].nullable = nodes[inner].nullable;
+            return grp;
+        }
+        case '[':
+            return char_class();
+        case '.': {
+            node n{node_kind::any};
+            n.nullable = false;
+            return add(n);
+        }
+        case '\\':
+            return escape();
+        case '*': case '+': case '?': case '{': case ')':
+            throw std::logic_error("static_regex: unexpected metacharacter");
+        default:
+            return literal(c);
+        }
+    }
+
+    constexpr int literal(char c) {
+        node n{node_kind::literal};
+        n.ch = static_cast<unsigned char>(c);
+        n.nullable = false;
+        return add(n);
+    }
+
+    constexpr int class_node(const char_set& set) {
+        classes[class_count] = set;
+        node n{node_kind::char_class};
+        n.cls = class_count++;
+        n.nullable = false;
+        return add(n);
+    }
+
+    constexpr char escaped_char(char c) const {
+        switch (c) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        default: return c;
+        }
+    }
+
+    constexpr int escape() {
+        if (at_end()) {
+            throw std::logic_error("static_regex: trailing '\\'");
+        }
+        char c = peek();
+        ++pos;
+        if (is_class_escape(c)) {
+            return class_node(escape_class(c));
+        }
+        return literal(escaped_char(c));
+    }
+
+    // char_class := '[' '^'? (char | char '-' char | escape)+ ']'
+    constexpr int char_class() {
+        char_set set;
+        bool negate = false;
+        if (!at_end() && peek() == '^') {
+            negate = true;
+            ++pos;
+        }
+        bool first = true;
+        while (!at_end() && (peek() != ']' || first)) {
+            first = false;
+            char c = peek();
+            ++pos;
+            if (c == '\\') {
+                if (at_end()) {
+                    throw std::logic_error("static_regex: trailing '\\'");
+                }
+                char e = peek();
+                ++pos;
+                if (is_class_escape(e)) {
+                    set.merge(escape_class(e));
+                    continue;
+                }
+                c = escaped_char(e);
+            }
+            if (pos + 1 < pattern.size() && peek() == '-' && pattern[pos + 1] != ']') {
+                char last = pattern[pos + 1];
+                pos += 2;
+                if (static_cast<unsigned char>(last) < static_cast<unsigned char>(c)) {
+                    throw std::logic_error("static_regex: bad class range");
+                }
+                set.set_range(static_cast<unsigned char>(c), static_cast<unsigned char>(last));
+            } else {
+                set.set(static_cast<unsigned char>(c));
+            }
+        }
+        if (at_end()) {
+            throw std::logic_error("static_regex: missing ']'");
+        }
+        ++pos;
+        if (negate) {
+            set.invert();
+        }
+        return class_node(set);
+    }
+};
+
+// Emits the backtracking program for a parse tree. With code == nullptr
+// it only counts instructions, which sizes the real program.
+template<std::size_t MaxNodes>
+struct code_generator {
+    const parser<MaxNodes>& tree;
+    instruction* code;
+    std::size_t count = 0;
+
+    constexpr std::size_t emit(op c, unsigned char ch = 0, std::size_t x = 0, std::size_t y = 0) {
+        if (code) {
+            code[count] = instruction{c, ch, static_cast<unsigned short>(x), static_cast<unsigned short>(y)};
+        }
+        return count++;
+    }
+
+    constexpr void set_x(std::size_t at, std::size_t x) {
+        if (code) {
+            code[at].x = static_cast<unsigned short>(x);
+        }
+    }
+
+    constexpr void set_y(std::size_t at, std::size_t y) {
+        if (code) {
+            code[at].y = static_cast<unsigned short>(y);
+        }
+    }
+
+    constexpr void generate(int index) {
+        const node& n = tree.nodes[index];
+        switch (n.kind) {
+        case node_kind::literal:
+            emit(op::literal, n.ch);
+            break;
+        case node_kind::any:
+            emit(op::any);
+            break;
+        case node_kind::char_class:
+            emit(op::char_class, 0, n.cls);
+            break;
+        case node_kind::empty:
+            break;
+        case node_kind::concat:
+            for (int c = n.first_child; c != -1; c = tree.nodes[c].next_sibling) {
+                generate(c);
+            }
+            break;
+        case node_kind::group:
+            if (n.group != 0) {
+                emit(op::save, 0, 2 * n.group);
+            }
+            generate(n.first_child);
+            if (n.group != 0) {
+                emit(op::save, 0, 2 * n.group + 1);
+            }
+            break;
+        case node_kind::alternation: {
+            // Each branch but the last: split(branch, next); branch; jump(end)
+            std::size_t jumps[MaxNodes]{};
+            std::size_t jump_count = 0;
+            for (int c = n.first_child; c != -1; c = tree.nodes[c].next_sibling) {
+                if (tree.nodes[c].next_sibling == -1) {
+                    generate(c);
+                    break;
+                }
+                std::size_t split = emit(op::split, 0, count + 1);
+                generate(c);
+                jumps[jump_count++] = emit(op::jump);
+                set_y(split, count);
+            }
+            for (std::size_t j = 0; j < jump_count; ++j) {
+                set_x(jumps[j], count);
+            }
+            break;
+        }
+        case node_kind::repeat: {
+            for (std::size_t i = 0; i < n.min; ++i) {
+                generate(n.first_child);
+            }
+            if (n.max == unbounded) {
+                // loop: split(body, end); body; jump(loop)
+                std::size_t loop = emit(op::split, 0, count + 1);
+                generate(n.first_child);
+                emit(op::jump, 0, loop);
+                set_y(loop, count);
+            } else {
+                // Each optional copy: split(body, end); body
+                code_generator measure{tree, nullptr};
+                measure.generate(n.first_child);
+                std::size_t first = count;
+                for (std::size_t i = n.min; i < n.max; ++i) {
+                    emit(op::split, 0, count + 1);
+                    generate(n.first_child);
+                }
+                for (std::size_t i = n.min; i < n.max; ++i) {
+                    set_y(first + (i - n.min) * (measure.count + 1), count);
+                }
+            }
+            break;
+        }
+        }
+    }
+};
+
+template<std::size_t Instructions, std::size_t Classes>
+struct program {
+    instruction code[Instructions]{};
+    char_set classes[Classes == 0 ? 1 : Classes]{};
+    std::size_t captures = 0;
+};
+
+// Upper bound on parse tree nodes: one per pattern character plus one
+// sequence node per branch
+template<fixed_string Pattern>
+inline constexpr std::size_t max_nodes = 2 * Pattern.size() + 2;
+
+template<fixed_string Pattern>
+constexpr auto parse() {
+    parser<max_nodes<Pattern>> p(std::string_view(Pattern.data, Pattern.size()));
+    p.parse();
+    return p;
+}
+
+template<fixed_string Pattern>
+constexpr std::size_t instruction_count() {
+    auto tree = parse<Pattern>();
+    code_generator<max_nodes<Pattern>> gen{tree, nullptr};
+    gen.generate(tree.root);
+    return gen.count + 1;
+}
+
+template<fixed_string Pattern>
+constexpr auto compile() {
+    auto tree = parse<Pattern>();
+    constexpr std::size_t size = instruction_count<Pattern>();
+    static_assert(size < 65536, "static_regex: pattern too large");
+    program<size, max_nodes<Pattern>> prog;
+    code_generator<max_nodes<Pattern>> gen{tree, prog.code};
+    gen.generate(tree.root);
+    gen.emit(op::match);
+    for (std::size_t i = 0; i < tree.class_count; ++i) {
+        prog.classes[i] = tree.classes[i];
+    }
+    prog.captures = tree.group_count;
+    return prog;
+}
+
+// Where to resume after a failure: at pc with input sp, or (for a save
+// being undone) by putting old back into slots[slot]
+struct backtrack_entry {
+    std::size_t pc;
+    const char* sp;
+    std::size_t slot;
+    const char* old;
+};
+
+inline constexpr std::size_t no_slot = static_cast<std::size_t>(-1);
+
+// Pending alternatives of one match. Most matches need only a few, kept
+// inline; long inputs under a greedy loop need one per character and
+// spill to the heap, never to the call stack.
+class backtrack_stack {
+public:
+    bool empty() const { return size_ == 0; }
+
+    void push(const backtrack_entry& e) {
+        if (size_ < inline_capacity) {
+            inline_[size_] = e;
+        } else {
+            spill_.push_back(e);
+        }
+        ++size_;
+    }
+
+    backtrack_entry pop() {
+        --size_;
+        if (size_ < inline_capacity) {
+            return inline_[size_];
+        }
+        backtrack_entry e = spill_.back();
+        spill_.pop_back();
+        return e;
+    }
+
+private:
+    static constexpr std::size_t inline_capacity = 64;
+    backtrack_entry inline_[inline_capacity];
+    std::vector<backtrack_entry> spill_;
+    std::size_t size_ = 0;
+};
+
+// Backtracking matcher; slots[2k], slots[2k+1] bound capture k
+inline bool run(const instruction* code, const char_set* classes, std::size_t pc,
+                const char* sp, const char* end, const char** slots) {
+    backtrack_stack pending;
+    while (true) {
+        const instruction& in = code[pc];
+        bool failed = false;
+        switch (in.code) {
+        case op::literal:
+            if (sp == end || static_cast<unsigned char>(*sp) != in.ch) {
+                failed = true;
+                break;
+            }
+            ++sp;
+            ++pc;
+            break;
+        case op::any:
+            if (sp == end) {
+                failed = true;
+                break;
+            }
+            ++sp;
+            ++pc;
+            break;
+        case op::char_class:
+            if (sp == end || !classes[in.x].test(static_cast<unsigned char>(*sp))) {
+                failed = true;
+                break;
+            }
+            ++sp;
+            ++pc;
+            break;
+        case op::split:
+            // Try x now, y if that fails
+            pending.push({in.y, sp, no_slot, nullptr});
+            pc = in.x;
+            break;
+        case op::jump:
+            pc = in.x;
+            break;
+        case op::save:
+            pending.push({0, nullptr, in.x, slots[in.x]});
+            slots[in.x] = sp;
+            ++pc;
+            break;
+        case op::match:
+            if (sp == end) {
+                return true;
+            }
+            failed = true;
+            break;
+        }
+        // Undo saves back to the most recent split, and take its other branch
+        while (failed) {
+            if (pending.empty()) {
+                return false;
+            }
+            backtrack_entry e = pending.pop();
+            if (e.slot != no_slot) {
+                slots[e.slot] = e.old;
+            } else {
+                pc = e.pc;
+                sp = e.sp;
+                failed = false;
+            }
+        }
+    }
+}
+
+} // namespace regex_detail
+
+template<fixed_string Pattern>
+struct static_regex {
+    static constexpr auto program = regex_detail::compile<Pattern>();
+    static constexpr std::size_t captures = program.captures;
+
+    // Element 0 is the whole input, element k the text of group k
+    using match_result = std::array<std::string_view, captures + 1>;
+
+    static std::optional<match_result> match(std::string_view input) {
+        const char* slots[2 * (captures + 1)] = {};
+        const char* begin = input.data();
+        const char* end = begin + input.size();
+        if (!regex_detail::run(program.code, program.classes, 0, begin, end, slots)) {
+            return std::nullopt;
+        }
+        match_result result;
+        result[0] = input;
+        for (std::size_t k = 1; k <= captures; ++k) {
+            if (slots[2 * k]) {
+                result[k] = std::string_view(slots[2 * k], slots[2 * k + 1] - slots[2 * k]);
+            }
+        }
+        return result;
+    }
+};
+
+// Converts captured text to T; false if it is not a valid T
+template<typename T>
+bool from_capture(std::string_view text, T& value) {
+    if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string>) {
+        value = T(text);
+        return true;
+    } else {
+        static_assert(std::is_arithmetic_v<T>, "captures convert to numbers and strings only");
+        const char* last = text.data() + text.size();
+        auto [ptr, ec] = std::from_chars(text.data(), last, value);
+        return ec == std::errc{} && ptr == last;
+    }
+}
+
+// Matches input against Pattern and converts group k to the k-th type
+template<fixed_string Pattern, typename... Ts>
+std::optional<std::tuple<Ts...>> match_as(std::string_view input) {
+    using regex = static_regex<Pattern>;
+    static_assert(regex::captures == sizeof...(Ts), "one type per capture group is required");
+    auto groups = regex::match(input);
+    if (!groups) {
+        return std::nullopt;
+    }
+    std::tuple<Ts...> values;
+    bool ok = [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return (from_capture((*groups)[I + 1], std::get<I>(values)) && ...);
+    }(std::index_sequence_for<Ts...>{});
+    if (!ok) {
+        return std::nullopt;
+    }
+    return values;
+}
+
+} // namespace cspp51045
+#endif
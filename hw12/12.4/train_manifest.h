@@ -0,0 +1,469 @@
+#ifndef TRAIN_MANIFEST_H
+#define TRAIN_MANIFEST_H
+#include "flexible_factory.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary train manifests: a list of products of one flexible_abstract_factory
+// with the constructor arguments of each, written once and mapped into
+// memory by every process that rebuilds the train.
+//
+// Layout (host byte order; a manifest is read on the kind of machine that
+// wrote it):
+//     manifest_header                 32 bytes
+//     uint32_t payload_bytes[product_count], padded to a multiple of 8
+//     record[record_count]            record_stride bytes each
+// A record is a uint32_t product index (the product's position in the
+// factory's list) followed, from byte 8, by that product's constructor
+// arguments, each at its natural alignment. Every record has the stride of
+// the largest one, so record i is found without reading records before it.
+// Constructor arguments must be trivially copyable.
+
+namespace cspp51045 {
+
+struct manifest_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t product_count;
+    std::uint32_t record_stride;
+    std::uint32_t reserved;
+    std::uint64_t record_count;
+};
+
+inline constexpr char manifest_magic[8] = {'T', 'R', 'A', 'I', 'N', 'M', 'F', '\0'};
+inline constexpr std::uint32_t manifest_version = 1;
+
+namespace manifest_detail {
+
+inline constexpr std::size_t record_prefix = 8;
+
+constexpr std::size_t round_up(std::size_t n, std::size_t align) {
+    return (n + align - 1) / align * align;
+}
+
+// Where each of Args... sits in a record's payload
+template<typename... Args>
+struct packed_args {
+    static_assert((std::is_trivially_copyable_v<Args> && ...),
+                  "manifest constructor arguments must be trivially copyable");
+
+    static constexpr std::array<std::size_t, sizeof...(Args)> offsets = [] {
+        std::array<std::size_t, sizeof...(Args)> result{};
+        std::size_t at = 0, i = 0;
+        ((at = round_up(at, alignof(Args)), result[i++] = at, at += sizeof(Args)), ...);
+        return result;
+    }();
+
+    static constexpr std::size_t size = [] {
+        std::size_t at = 0;
+        ((at = round_up(at, alignof(Args)) + sizeof(Args)), ...);
+        return at;
+    }();
+
+    static void store([[maybe_unused]] std::byte* payload, const Args&... args) {
+        std::size_t i = 0;
+        (std::memcpy(payload + offsets[i++], &args, sizeof(Args)), ...);
+    }
+
+    template<std::size_t... Is>
+    static std::tuple<Args...> load([[maybe_unused]] const std::byte* payload, std::index_sequence<Is...>) {
+        std::tuple<Args...> result;
+        (std::memcpy(&std::get<Is>(result), payload + offsets[Is], sizeof(Args)), ...);
+        return result;
+    }
+
+    static std::tuple<Args...> load(const std::byte* payload) {
+        return load(payload, std::index_sequence_for<Args...>());
+    }
+};
+
+// Constructor arguments of one entry of a factory's product list
+template<typename T>
+struct manifest_entry {
+    using product = T;
+    using packing = packed_args<>;
+};
+
+template<typename R, typename... Args>
+struct manifest_entry<R(Args...)> {
+    using product = R;
+    using packing = packed_args<std::decay_t<Args>...>;
+};
+
+// A read-only mapping of a whole file
+class file_mapping {
+public:
+    explicit file_mapping(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "stat " + path);
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ != 0) {
+            void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "mmap " + path);
+            }
+            data_ = static_cast<const std::byte*>(data);
+        }
+        ::close(fd);
+    }
+
+    file_mapping(file_mapping&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    file_mapping& operator=(file_mapping&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~file_mapping() { unmap(); }
+
+    const std::byte* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void unmap() noexcept {
+        if (data_) {
+            ::munmap(const_cast<std::byte*>(data_), size_);
+        }
+    }
+
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace manifest_detail
+
+// Manifests of the products of one abstract factory
+//     using TrainManifest = train_manifest<TrainFactory>;
+//     TrainManifest::writer out("train.manifest");
+//     out.add<Locomotive>(5000.0);
+//     out.add<FreightCar>(50000L);
+//     out.finish();
+//
+//     TrainManifest manifest("train.manifest");       // maps the file
+//     auto cars = manifest.create_all(realFactory);   // every car, now
+//     lazy_train<TrainFactory> train(manifest, realFactory);
+//     train.get<FreightCar>(1).display();             // created here
+template<typename AbstractFactory>
+class train_manifest;
+
+template<typename... Types>
+class train_manifest<flexible_abstract_factory<Types...>> {
+    template<typename T>
+    using manifest_entry_t = manifest_detail::manifest_entry<T>;
+
+    template<typename U>
+    static constexpr std::size_t index
+        = index_of_v<U, type_list<typename manifest_entry_t<Types>::product...>>;
+
+public:
+    using factory_type = flexible_abstract_factory<Types...>;
+
+    // One created product, whichever it is
+    using car = std::variant<std::unique_ptr<typename manifest_entry_t<Types>::product>...>;
+
+    template<typename U>
+    using arguments_t = decltype(manifest_entry_t<type_at_t<index<U>, type_list<Types...>>>
+                                     ::packing::load(nullptr));
+
+    static constexpr std::uint32_t product_count = sizeof...(Types);
+
+    static constexpr std::uint32_t record_stride = static_cast<std::uint32_t>(
+        manifest_detail::round_up(manifest_detail::record_prefix
+                                      + std::max({std::size_t(0), manifest_entry_t<Types>::packing::size...}),
+                                  8));
+
+    // Appends records to a new manifest file
+    class writer {
+    public:
+        explicit writer(const std::string& path)
+            : out_(path, std::ios::binary | std::ios::trunc), path_(path) {
+            if (!out_) {
+                throw std::runtime_error("train_manifest: cannot create " + path);
+            }
+            write_header();
+            std::array<std::uint32_t, round_up_products> sizes{};
+            std::size_t i = 0;
+            ((sizes[i++] = static_cast<std::uint32_t>(manifest_entry_t<Types>::packing::size)), ...);
+            out_.write(reinterpret_cast<const char*>(sizes.data()), sizeof(sizes));
+        }
+
+        writer(const writer&) = delete;
+        writer& operator=(const writer&) = delete;
+
+        ~writer() {
+            if (out_.is_open()) {
+                try {
+                    finish();
+                } catch (...) {
+                }
+            }
+        }
+
+        template<typename U, typename... Args>
+        void add(Args&&... args) {
+            static_assert(index<U> < sizeof...(Types), "U is not a product of this factory");
+            using packing = typename manifest_entry_t<type_at_t<index<U>, type_list<Types...>>>::packing;
+            std::array<std::byte, record_stride> record{};
+            auto id = static_cast<std::uint32_t>(index<U>);
+            std::memcpy(record.data(), &id, sizeof(id));
+            store(packing(), record.data() + manifest_detail::record_prefix, std::forward<Args>(args)...);
+            out_.write(reinterpret_cast<const char*>(record.data()), record.size());
+            ++count_;
+        }
+
+        std::uint64_t size() const { return count_; }
+
+        // Writes the record count and closes the file
+        void finish() {
+            out_.seekp(0);
+            write_header();
+            out_.close();
+            if (!out_) {
+                throw std::runtime_error("train_manifest: cannot write " + path_);
+            }
+        }
+
+    private:
+        // Converted to the signature's parameter types, as create would
+        template<typename... Params, typename... Args>
+        static void store(manifest_detail::packed_args<Params...>, std::byte* payload, Args&&... args) {
+            manifest_detail::packed_args<Params...>::store(payload, Params(std::forward<Args>(args))...);
+        }
+
+        void write_header() {
+            manifest_header header{};
+            std::memcpy(header.magic, manifest_magic, sizeof(header.magic));
+            header.version = manifest_version;
+            header.product_count = product_count;
+            header.record_stride = record_stride;
+            header.record_count = count_;
+            out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        std::ofstream out_;
+        std::string path_;
+        std::uint64_t count_ = 0;
+    };
+
+    // Maps a manifest written for this factory. Only the header is read
+    // now; records are paged in by the kernel as they are first touched.
+    explicit train_manifest(const std::string& path) : mapping_(path) {
+        const std::byte* data = mapping_.data();
+        manifest_header header;
+        if (mapping_.size() < records_offset) {
+            throw std::runtime_error("train_manifest: " + path + " is too short");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, manifest_magic, sizeof(header.magic)) != 0
+            || header.version != manifest_version) {
+            throw std::runtime_error("train_manifest: " + path + " is not a version "
+                                     + std::to_string(manifest_version) + " manifest");
+        }
+        std::array<std::uint32_t, round_up_products> sizes;
+        std::memcpy(sizes.data(), data + sizeof(header), sizeof(sizes));
+        std::size_t i = 0;
+        bool same_products = header.product_count == product_count && header.record_stride == record_stride
+            && ((sizes[i++] == manifest_entry_t<Types>::packing::size) && ...);
+        if (!same_products) {
+            throw std::runtime_error("train_manifest: " + path + " was written for a different factory");
+        }
+        if ((mapping_.size() - records_offset) / record_stride < header.record_count) {
+            throw std::runtime_error("train_manifest: " + path + " is truncated");
+        }
+        count_ = static_cast<std::size_t>(header.record_count);
+        records_ = data + records_offset;
+    }
+
+    std::size_t size() const { return count_; }
+
+    // Position of record i's product in the factory's list. Checked on
+    // every read, since it picks the function that reads the record.
+    std::uint32_t product_index(std::size_t i) const {
+        check(i);
+        std::uint32_t id;
+        std::memcpy(&id, record(i), sizeof(id));
+        if (id >= product_count) {
+            throw std::runtime_error("train_manifest: record " + std::to_string(i) + " is corrupt");
+        }
+        return id;
+    }
+
+    template<typename U>
+    bool holds(std::size_t i) const {
+        return product_index(i) == index<U>;
+    }
+
+    // Record i's constructor arguments, read in place
+    template<typename U>
+    arguments_t<U> arguments(std::size_t i) const {
+        if (!holds<U>(i)) {
+            throw std::invalid_argument("train_manifest: record " + std::to_string(i)
+                                        + " holds a different product");
+        }
+        using packing = typename manifest_entry_t<type_at_t<index<U>, type_list<Types...>>>::packing;
+        return packing::load(record(i) + manifest_detail::record_prefix);
+    }
+
+    car create(factory_type& factory, std::size_t i) const {
+        return creators[product_index(i)](factory, record(i) + manifest_detail::record_prefix);
+    }
+
+    // Every car, in manifest order
+    std::vector<car> create_all(factory_type& factory) const {
+        std::vector<car> cars;
+        cars.reserve(count_);
+        for (std::size_t i = 0; i < count_; ++i) {
+            cars.push_back(create(factory, i));
+        }
+        return cars;
+    }
+
+private:
+    template<typename T>
+    friend class lazy_train;
+
+    static constexpr std::size_t round_up_products = manifest_detail::round_up(sizeof...(Types), 2);
+    static constexpr std::size_t records_offset
+        = sizeof(manifest_header) + round_up_products * sizeof(std::uint32_t);
+
+    using creator = car (*)(factory_type&, const std::byte*);
+    using raw_creator = void* (*)(factory_type&, const std::byte*);
+    using deleter = void (*)(void*);
+
+    template<typename T>
+    static car create_one(factory_type& factory, const std::byte* payload) {
+        using product = typename manifest_entry_t<T>::product;
+        return std::apply([&factory](auto&&... args) { return car(factory.template create<product>(args...)); },
+                          manifest_entry_t<T>::packing::load(payload));
+    }
+
+    template<typename T>
+    static void* create_raw(factory_type& factory, const std::byte* payload) {
+        using product = typename manifest_entry_t<T>::product;
+        return std::apply([&factory](auto&&... args) {
+            return static_cast<void*>(factory.template create<product>(args...).release());
+        }, manifest_entry_t<T>::packing::load(payload));
+    }
+
+    template<typename T>
+    static void destroy(void* p) {
+        delete static_cast<typename manifest_entry_t<T>::product*>(p);
+    }
+
+    static constexpr creator creators[] = {&create_one<Types>...};
+    static constexpr raw_creator raw_creators[] = {&create_raw<Types>...};
+    static constexpr deleter deleters[] = {&destroy<Types>...};
+
+    const std::byte* record(std::size_t i) const { return records_ + i * record_stride; }
+
+    void check(std::size_t i) const {
+        if (i >= count_) {
+            throw std::out_of_range("train_manifest: record " + std::to_string(i) + " of "
+                                    + std::to_string(count_));
+        }
+    }
+
+    manifest_detail::file_mapping mapping_;
+    const std::byte* records_ = nullptr;
+    std::size_t count_ = 0;
+};
+
+// A train whose cars are created from a manifest the first time they are
+// asked for. Construction costs one zero-filled slot table, which calloc
+// takes straight from fresh pages, so it does not grow with the train in
+// practice. The manifest and factory must outlive the train; a lazy_train
+// is not safe to share between threads.
+template<typename AbstractFactory>
+class lazy_train {
+    using manifest_type = train_manifest<AbstractFactory>;
+
+public:
+    lazy_train(const manifest_type& manifest, AbstractFactory& factory)
+        : manifest_(manifest), factory_(factory),
+          slots_(static_cast<void**>(std::calloc(std::max<std::size_t>(manifest.size(), 1), sizeof(void*)))) {
+        if (!slots_) {
+            throw std::bad_alloc();
+        }
+    }
+
+    lazy_train(const lazy_train&) = delete;
+    lazy_train& operator=(const lazy_train&) = delete;
+
+    ~lazy_train() {
+        for (auto [i, id] : created_) {
+            manifest_type::deleters[id](slots_.get()[i]);
+        }
+    }
+
+    std::size_t size() const { return manifest_.size(); }
+
+    // Car i, created now if this is its first use
+    template<typename U>
+    U& get(std::size_t i) {
+        if (!manifest_.template holds<U>(i)) {
+            throw std::invalid_argument("lazy_train: car " + std::to_string(i) + " is not of the requested type");
+        }
+        void*& slot = slots_.get()[i];
+        if (!slot) {
+            // Room first, so that recording the car cannot throw once it exists
+            if (created_.size() == created_.capacity()) {
+                created_.reserve(created_.capacity() * 2 + 16);
+            }
+            std::uint32_t id = manifest_.product_index(i);
+            slot = manifest_type::raw_creators[id](factory_, manifest_.record(i) + manifest_detail::record_prefix);
+            created_.emplace_back(i, id);
+        }
+        return *static_cast<U*>(slot);
+    }
+
+    bool created(std::size_t i) const { return i < size() && slots_.get()[i] != nullptr; }
+    std::size_t created_count() const { return created_.size(); }
+
+private:
+    struct free_slots {
+        void operator()(void** p) const { std::free(p); }
+    };
+
+    const manifest_type& manifest_;
+    AbstractFactory& factory_;
+    std::unique_ptr<void*[], free_slots> slots_;
+    std::vector<std::pair<std::size_t, std::uint32_t>> created_; // car and its product index
+};
+
+} // namespace cspp51045
+#endif
@@ -1,4 +1,5 @@
 #include "../12.4/flexible_factory.h"
+#include "../12.4/prototype_factory.h"
 #include <iostream>
 #include <memory>
 #include <string>
@@ -141,14 +142,35 @@ struct parameterized_factory;
 template<template<typename> class ConcreteTemplate>
 struct parameterized_factory<TrainFactory, ConcreteTemplate> : public flexible_concrete_factory<
     TrainFactory,
-    concrete_pair<TrainFactory, Locomotive(double), ConcreteTemplate<Locomotive>>,
-    concrete_pair<TrainFactory, FreightCar(long), ConcreteTemplate<FreightCar>>,
-    concrete_pair<TrainFactory, Caboose(), ConcreteTemplate<Caboose>>
+    ConcreteTemplate<Locomotive>,
+    ConcreteTemplate<FreightCar>,
+    ConcreteTemplate<Caboose>
 > {};
 
+// Parameterized prototype factory: constructs one car of each kind up
+// front and copies it from then on
+template<typename AbstractFactory, template<typename> class ConcreteTemplate>
+struct parameterized_prototype_factory;
+
+template<template<typename> class ConcreteTemplate>
+struct parameterized_prototype_factory<TrainFactory, ConcreteTemplate> : public flexible_prototype_factory<
+    TrainFactory,
+    ConcreteTemplate<Locomotive>,
+    ConcreteTemplate<FreightCar>,
+    ConcreteTemplate<Caboose>
+> {
+    using flexible_prototype_factory<
+        TrainFactory,
+        ConcreteTemplate<Locomotive>,
+        ConcreteTemplate<FreightCar>,
+        ConcreteTemplate<Caboose>
+    >::flexible_prototype_factory;
+};
+
 // Define concrete factories using the parameterized approach
 using ModelTrainFactory = parameterized_factory<TrainFactory, Model>;
 using RealTrainFactory = parameterized_factory<TrainFactory, Real>;
+using RealPrototypeFactory = parameterized_prototype_factory<TrainFactory, Real>;
 
 int main() {
     cout << "Creating model train:" << endl;
@@ -176,5 +198,17 @@ int main() {
     realFreight->display();
     realCaboose->display();
     
+    // Only the prototypes announce themselves; their copies are silent
+    cout << "\n\nCreating real train from prototypes:" << endl;
+    RealPrototypeFactory prototypeFactory(Real<Locomotive>(12000.0), Real<FreightCar>(10000L), Real<Caboose>());
+    unique_ptr<Locomotive> prototypeLoco = prototypeFactory.clone<Locomotive>();
+    auto prototypeFreight = prototypeFactory.clone_n<FreightCar>(5000);
+    unique_ptr<Caboose> prototypeCaboose = prototypeFactory.clone<Caboose>();
+    
+    cout << "\nDisplaying real train components (" << prototypeFreight.size() << " freight cars):" << endl;
+    prototypeLoco->display();
+    prototypeFreight[0].display();
+    prototypeCaboose->display();
+    
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,240 @@
+#ifndef FORMAT_BACKEND_H
+#define FORMAT_BACKEND_H
+
+#include <cerrno>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+
+// Formatting backend: std::format when the standard library has it,
+// otherwise {fmt} (header-only, from fmt/include or the system). Format
+// specs are checked at compile time by both. JOINER_HAS_FORMAT is defined
+// to 1 when either one is available.
+#if __has_include(<format>)
+#include <format>
+#endif
+
+#if defined(__cpp_lib_format)
+#define JOINER_FORMAT_STD 1
+#elif __has_include(<fmt/format.h>)
+#ifndef FMT_HEADER_ONLY
+#define FMT_HEADER_ONLY
+#endif
+#include <fmt/format.h>
+#define JOINER_FORMAT_FMT 1
+#endif
+
+#if defined(JOINER_FORMAT_STD) || defined(JOINER_FORMAT_FMT)
+#define JOINER_HAS_FORMAT 1
+
+namespace joiner_format {
+
+#ifdef JOINER_FORMAT_STD
+using buffer = std::string;
+
+template<typename... Args>
+using format_string = std::format_string<Args...>;
+
+template<typename... Args>
+void format_to(buffer& out, format_string<Args...> spec, Args&&... args) {
+    std::format_to(std::back_inserter(out), spec, std::forward<Args>(args)...);
+}
+#else
+using buffer = fmt::memory_buffer;
+
+template<typename... Args>
+using format_string = fmt::format_string<Args...>;
+
+template<typename... Args>
+void format_to(buffer& out, format_string<Args...> spec, Args&&... args) {
+    fmt::format_to(std::back_inserter(out), spec, std::forward<Args>(args)...);
+}
+#endif
+
+inline void append(buffer& out, std::string_view s) {
+    out.append(s.data(), s.data() + s.size());
+}
+
+// Hands the whole buffer to the stream in one unformatted write
+inline void write(std::ostream& os, const buffer& out) {
+    os.write(out.data(), static_cast<std::streamsize>(out.size()));
+}
+
+// Writes the whole buffer to a file descriptor, retrying short writes
+inline void write(int fd, const buffer& out) {
+    const char* data = out.data();
+    std::size_t left = out.size();
+    while (left != 0) {
+        ssize_t n = ::write(fd, data, left);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error{errno, std::generic_category(), "write failed"};
+        }
+        data += n;
+        left -= static_cast<std::size_t>(n);
+    }
+}
+
+// Element types whose default-spec output is identical to operator<<
+// on a stream with default flags
+template<typename T>
+inline constexpr bool matches_ostream_v =
+    (std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>
+     && !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char>
+     && !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char8_t>
+     && !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>)
+    || std::is_convertible_v<const T&, std::string_view>;
+
+// True if os has no flags, width or fill that operator<< would honour
+inline bool has_default_format(const std::ostream& os) {
+    return os.flags() == (std::ios_base::skipws | std::ios_base::dec) && os.width() == 0;
+}
+
+// Formats value the way operator<< would (floating point uses %g with the
+// stream's precision)
+template<typename T>
+void format_default(buffer& out, const T& value, int precision) {
+    if constexpr (std::is_floating_point_v<T>) {
+        format_to(out, "{:.{}g}", value, precision);
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        append(out, std::string_view(value));
+    } else {
+        format_to(out, "{}", value);
+    }
+}
+
+// Formats a whole range as "[e0, e1, ...]" into out, each element with spec
+template<typename Range>
+void format_range(buffer& out, const Range& r,
+                  format_string<const std::ranges::range_value_t<Range>&> spec,
+                  std::string_view delim = ", ") {
+    out.push_back('[');
+    bool first_elem = true;
+    for (const auto& value : r) {
+        if (!first_elem) {
+            append(out, delim);
+        } else {
+            first_elem = false;
+        }
+        format_to(out, spec, value);
+    }
+    out.push_back(']');
+}
+
+// Container printer: formats the range in memory, then writes it once
+template<typename Range>
+void print_range(std::ostream& os, const Range& r,
+                 format_string<const std::ranges::range_value_t<Range>&> spec,
+                 std::string_view delim = ", ") {
+    buffer out;
+    format_range(out, r, spec, delim);
+    write(os, out);
+}
+
+template<typename Range>
+void print_range(int fd, const Range& r,
+                 format_string<const std::ranges::range_value_t<Range>&> spec,
+                 std::string_view delim = ", ") {
+    buffer out;
+    format_range(out, r, spec, delim);
+    write(fd, out);
+}
+
+} // namespace joiner_format
+
+// format_joiner class template
+// Output iterator like ostream_joiner that formats each T with a
+// compile-time-checked spec into a memory buffer. The buffer goes to the
+// stream or file descriptor in blocks of flush_size, and the remainder
+// when the last copy is destroyed or flush() is called.
+template<typename T>
+class format_joiner {
+public:
+    // Iterator traits
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = void;
+    using pointer = void;
+    using reference = void;
+    using spec_type = joiner_format::format_string<const T&>;
+
+    static constexpr std::size_t flush_size = 1 << 16;
+
+    format_joiner(std::ostream& os, std::string_view delim, spec_type spec = "{}")
+        : state_(std::make_shared<state>(&os, -1, delim, spec)) {}
+
+    format_joiner(int fd, std::string_view delim, spec_type spec = "{}")
+        : state_(std::make_shared<state>(nullptr, fd, delim, spec)) {}
+
+    format_joiner& operator*() {
+        return *this;
+    }
+
+    format_joiner& operator=(const T& value) {
+        state_->put(value);
+        return *this;
+    }
+
+    format_joiner& operator++() { return *this; }
+    format_joiner& operator++(int) { return *this; }
+
+    void flush() { state_->flush(); }
+
+private:
+    struct state {
+        std::ostream* os_;
+        int fd_;
+        std::string_view delimiter_;
+        spec_type spec_;
+        bool first_elem_ = true;
+        joiner_format::buffer buffer_;
+
+        state(std::ostream* os, int fd, std::string_view delim, spec_type spec)
+            : os_(os), fd_(fd), delimiter_(delim), spec_(spec) {}
+
+        // Errors from a destructor flush cannot be reported
+        ~state() {
+            try {
+                flush();
+            } catch (...) {
+            }
+        }
+
+        void put(const T& value) {
+            if (!first_elem_) {
+                joiner_format::append(buffer_, delimiter_);
+            } else {
+                first_elem_ = false;
+            }
+            joiner_format::format_to(buffer_, spec_, value);
+            if (buffer_.size() >= flush_size) {
+                flush();
+            }
+        }
+
+        void flush() {
+            if (buffer_.size() != 0) {
+                if (os_) {
+                    joiner_format::write(*os_, buffer_);
+                } else {
+                    joiner_format::write(fd_, buffer_);
+                }
+                buffer_.clear();
+            }
+        }
+    };
+
+    std::shared_ptr<state> state_;
+};
+
+#endif // JOINER_FORMAT_STD || JOINER_FORMAT_FMT
+
+#endif
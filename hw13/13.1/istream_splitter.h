@@ -0,0 +1,307 @@
+#ifndef ISTREAM_SPLITTER_H
+#define ISTREAM_SPLITTER_H
+
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Reading counterpart to ostream_joiner: splits delimited text into fields
+// and yields them lazily as values of type T, so text written with
+//     std::copy(v.begin(), v.end(), ostream_joiner(os, ", "));
+// reads back with
+//     for (int x : buffer_splitter<int>(text, ", ")) ...
+// Numbers are parsed with std::from_chars; std::string and std::string_view
+// fields are returned as is. Trailing whitespace at the end of the input
+// (such as a final newline) is ignored.
+
+namespace splitter_detail {
+
+// Position of the first c in [first, last), or last
+inline const char* find_byte(const char* first, const char* last, char c) {
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi8(c);
+    for (; last - first >= 32; first += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+        if (mask != 0) {
+            return first + __builtin_ctz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i needle16 = _mm_set1_epi8(c);
+    for (; last - first >= 16; first += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle16)));
+        if (mask != 0) {
+            return first + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; first != last; ++first) {
+        if (*first == c) {
+            return first;
+        }
+    }
+    return last;
+}
+
+// Position of the first occurrence of delim in [first, last), or last
+inline const char* find_delimiter(const char* first, const char* last, std::string_view delim) {
+    while (true) {
+        first = find_byte(first, last, delim[0]);
+        if (static_cast<std::size_t>(last - first) < delim.size()) {
+            return last;
+        }
+        if (std::memcmp(first + 1, delim.data() + 1, delim.size() - 1) == 0) {
+            return first;
+        }
+        ++first;
+    }
+}
+
+template<typename T>
+T parse_field(std::string_view field) {
+    if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string>) {
+        return T(field);
+    } else {
+        static_assert(std::is_arithmetic_v<T>, "splitters yield numbers and strings only");
+        T value{};
+        const char* first = field.data();
+        const char* last = first + field.size();
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        if (ec != std::errc{} || ptr != last) {
+            throw std::runtime_error{"splitter: cannot parse field '" + std::string(field) + "'"};
+        }
+        return value;
+    }
+}
+
+inline std::string_view trim_trailing_space(std::string_view text) {
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+inline void check_delimiter(std::string_view delim) {
+    if (delim.empty()) {
+        throw std::invalid_argument{"splitter: delimiter must not be empty"};
+    }
+}
+
+// Fields of an in-memory buffer
+class buffer_fields {
+public:
+    buffer_fields(std::string_view text, std::string_view delim)
+        : text_(trim_trailing_space(text)), delimiter_(delim), done_(text_.empty()) {
+        check_delimiter(delim);
+    }
+
+    bool next(std::string_view& field) {
+        if (done_) {
+            return false;
+        }
+        const char* first = text_.data() + pos_;
+        const char* last = text_.data() + text_.size();
+        const char* end = find_delimiter(first, last, delimiter_);
+        field = std::string_view(first, end - first);
+        if (end == last) {
+            done_ = true;
+        } else {
+            pos_ = (end - text_.data()) + delimiter_.size();
+        }
+        return true;
+    }
+
+private:
+    std::string_view text_;
+    std::string_view delimiter_;
+    std::size_t pos_ = 0;
+    bool done_;
+};
+
+// Fields of a stream, read in blocks through the stream buffer; a field
+// that straddles two blocks is carried over to the next one
+class stream_fields {
+public:
+    static constexpr std::size_t block_size = 1 << 16;
+
+    stream_fields(std::istream& is, std::string_view delim) : is_(&is), delimiter_(delim) {
+        check_delimiter(delim);
+    }
+
+    bool next(std::string_view& field) {
+        while (!done_) {
+            const char* first = buffer_.data() + pos_;
+            const char* last = buffer_.data() + buffer_.size();
+            const char* end = find_delimiter(first, last, delimiter_);
+            if (end != last) {
+                field = std::string_view(first, end - first);
+                pos_ = (end - buffer_.data()) + delimiter_.size();
+                any_field_ = true;
+                return true;
+            }
+            if (!refill()) {
+                // Whatever is left is the last field; input that is only
+                // whitespace has no fields at all
+                done_ = true;
+                field = trim_trailing_space(std::string_view(buffer_).substr(pos_));
+                return any_field_ || !field.empty();
+            }
+        }
+        return false;
+    }
+
+private:
+    // Drops consumed text and appends the next block; false at end of input
+    bool refill() {
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+        std::size_t kept = buffer_.size();
+        buffer_.resize(kept + block_size);
+        std::streamsize got = is_->rdbuf()->sgetn(buffer_.data() + kept, block_size);
+        buffer_.resize(kept + static_cast<std::size_t>(got));
+        if (got == 0) {
+            is_->setstate(std::ios_base::eofbit);
+        }
+        return got != 0;
+    }
+
+    std::istream* is_;
+    std::string delimiter_;
+    std::string buffer_;
+    std::size_t pos_ = 0;
+    bool any_field_ = false;
+    bool done_ = false;
+};
+
+} // namespace splitter_detail
+
+// Read-only, read-ahead mapping of a whole file
+class mapped_file {
+public:
+    explicit mapped_file(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::system_error{errno, std::generic_category(), "mapped_file: open failed"};
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error{err, std::generic_category(), "mapped_file: fstat failed"};
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ != 0) {
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                int err = errno;
+                ::close(fd);
+                throw std::system_error{err, std::generic_category(), "mapped_file: mmap failed"};
+            }
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(p);
+        }
+        ::close(fd);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file() {
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+    }
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// basic_splitter class template
+// A single-pass input range; each field is parsed when the iterator
+// reaches it.
+template<typename T, typename Fields>
+class basic_splitter {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        iterator() = default;
+        explicit iterator(basic_splitter* splitter) : splitter_(splitter) {
+            advance();
+        }
+
+        const T& operator*() const { return splitter_->current_; }
+        const T* operator->() const { return &splitter_->current_; }
+
+        iterator& operator++() {
+            advance();
+            return *this;
+        }
+        void operator++(int) { advance(); }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) {
+            return it.splitter_ == nullptr;
+        }
+
+    private:
+        void advance() {
+            std::string_view field;
+            if (splitter_->fields_.next(field)) {
+                splitter_->current_ = splitter_detail::parse_field<T>(field);
+            } else {
+                splitter_ = nullptr;
+            }
+        }
+
+        basic_splitter* splitter_ = nullptr;
+    };
+
+    template<typename Source>
+    basic_splitter(Source&& source, std::string_view delim)
+        : fields_(std::forward<Source>(source), delim) {}
+
+    iterator begin() { return iterator(this); }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    Fields fields_;
+    T current_{};
+};
+
+// Splits an in-memory buffer (or a mapped_file's view())
+template<typename T>
+using buffer_splitter = basic_splitter<T, splitter_detail::buffer_fields>;
+
+// Splits a stream, reading it block by block. Fields live in a reused
+// block, so T should not be std::string_view here.
+template<typename T>
+using istream_splitter = basic_splitter<T, splitter_detail::stream_fields>;
+
+#endif
@@ -0,0 +1,222 @@
+#include "ostream_joiner.h"
+#include "sink_joiner.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Compares ostream_joiner with buffered_ostream_joiner (and, when a format
+// backend is available, format_joiner and the vector operator<<) on a
+// million-element vector<int> and vector<double> written to /dev/null,
+// then checks that every variant produces the same text. The sink joiners
+// are timed writing to a span, an mmapped file and /dev/null via writev.
+// Then a million wide strings are written as UTF-8 through a wide stream's
+// codecvt and through the joiners' own transcoder, next to the same text
+// written narrow. Finally, strings longer than a sink's blocks are checked
+// to come out whole.
+
+const char* SINK_FILE = "joiner_benchmark.out";
+
+template<typename Container, typename WriteFunc>
+double time_write(const Container& data, WriteFunc write, std::string& output, const std::string& name) {
+    std::ofstream sink("/dev/null");
+    auto start = std::chrono::high_resolution_clock::now();
+    write(sink, data);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::ostringstream os;
+    write(os, data);
+    output = os.str();
+
+    std::chrono::duration<double, std::milli> duration = end - start;
+    std::cout << name << " took " << duration.count() << " ms" << std::endl;
+    return duration.count();
+}
+
+template<typename Func>
+double time_run(Func func, const std::string& name) {
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> duration = end - start;
+    std::cout << name << " took " << duration.count() << " ms" << std::endl;
+    return duration.count();
+}
+
+void report(double baseline_ms, double ms, bool same) {
+    std::cout << "  speedup: " << baseline_ms / ms << "x, output "
+              << (same ? "identical" : "DIFFERS") << std::endl;
+}
+
+std::string read_file(const char* path) {
+    std::ifstream in(path);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+template<typename T>
+void compare_sinks(const std::vector<T>& data, const std::string& plain, double plain_ms) {
+    std::vector<char> out(plain.size() + 1024);
+    std::size_t written = 0;
+    double span_ms = time_run([&]() {
+        span_joiner joiner(out, ", ");
+        std::copy(data.begin(), data.end(), joiner);
+        written = joiner.size();
+    }, "  span_joiner");
+    report(plain_ms, span_ms, plain == std::string_view(out.data(), written));
+
+    double mmap_ms = time_run([&]() {
+        std::copy(data.begin(), data.end(), mmap_joiner(SINK_FILE, ", "));
+    }, "  mmap_joiner");
+    report(plain_ms, mmap_ms, plain == read_file(SINK_FILE));
+
+    int null_fd = ::open("/dev/null", O_WRONLY);
+    double writev_ms = time_run([&]() {
+        std::copy(data.begin(), data.end(), writev_joiner(null_fd, ", "));
+    }, "  writev_joiner");
+    ::close(null_fd);
+
+    int file_fd = ::open(SINK_FILE, O_WRONLY | O_TRUNC);
+    std::copy(data.begin(), data.end(), writev_joiner(file_fd, ", "));
+    ::close(file_fd);
+    report(plain_ms, writev_ms, plain == read_file(SINK_FILE));
+    std::remove(SINK_FILE);
+}
+
+template<typename T>
+void compare(const std::vector<T>& data, const std::string& label) {
+    std::string plain, buffered;
+
+    std::cout << label << " with " << data.size() << " elements:" << std::endl;
+    double plain_ms = time_write(data, [](std::ostream& os, const std::vector<T>& v) {
+        std::copy(v.begin(), v.end(), ostream_joiner(os, ", "));
+    }, plain, "  ostream_joiner");
+
+    double buffered_ms = time_write(data, [](std::ostream& os, const std::vector<T>& v) {
+        std::copy(v.begin(), v.end(), buffered_ostream_joiner(os, ", "));
+    }, buffered, "  buffered_ostream_joiner");
+
+    report(plain_ms, buffered_ms, plain == buffered);
+
+#ifdef JOINER_HAS_FORMAT
+    std::string formatted, printed;
+    double formatted_ms = time_write(data, [](std::ostream& os, const std::vector<T>& v) {
+        if constexpr (std::is_floating_point_v<T>) {
+            std::copy(v.begin(), v.end(), format_joiner<T>(os, ", ", "{:.6g}"));
+        } else {
+            std::copy(v.begin(), v.end(), format_joiner<T>(os, ", "));
+        }
+    }, formatted, "  format_joiner");
+    report(plain_ms, formatted_ms, plain == formatted);
+
+    double printed_ms = time_write(data, [](std::ostream& os, const std::vector<T>& v) {
+        os << v;
+    }, printed, "  vector operator<<");
+    report(plain_ms, printed_ms, "[" + plain + "]" == printed);
+#endif
+
+    std::string parallel;
+    double parallel_ms = time_write(data, [](std::ostream& os, const std::vector<T>& v) {
+        os << in_parallel(v);
+    }, parallel, "  vector operator<< in_parallel");
+    report(plain_ms, parallel_ms, "[" + plain + "]" == parallel);
+
+    compare_sinks(data, plain, plain_ms);
+}
+
+// Writes the same report as narrow UTF-8 strings and as wide strings
+void compare_wide(std::size_t size) {
+    const char* narrow_words[] = {"matcha", "h\u014djicha", "genmaicha", "caf\u00e9 au lait", "oolong",
+                                  "\u6771\u4eac", "earl grey", "rooibos"};
+    const wchar_t* wide_words[] = {L"matcha", L"h\u014djicha", L"genmaicha", L"caf\u00e9 au lait", L"oolong",
+                                   L"\u6771\u4eac", L"earl grey", L"rooibos"};
+    std::vector<std::string> narrow(size);
+    std::vector<std::wstring> wide(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        narrow[i] = narrow_words[i % 8] + std::string(" #") + std::to_string(i);
+        wide[i] = wide_words[i % 8] + std::wstring(L" #") + std::to_wstring(i);
+    }
+
+    std::cout << "vector<wstring> with " << size << " elements, as UTF-8:" << std::endl;
+    double narrow_ms = time_run([&]() {
+        std::ofstream sink("/dev/null");
+        std::copy(narrow.begin(), narrow.end(), buffered_ostream_joiner(sink, ", "));
+    }, "  narrow buffered_ostream_joiner");
+    std::ostringstream narrow_text;
+    std::copy(narrow.begin(), narrow.end(), buffered_ostream_joiner(narrow_text, ", "));
+
+    const std::locale utf8("C.UTF-8");
+    double codecvt_ms = time_run([&]() {
+        std::wofstream sink("/dev/null");
+        sink.imbue(utf8);
+        std::copy(wide.begin(), wide.end(), buffered_ostream_joiner(sink, L", "));
+    }, "  wide stream (codecvt)");
+    {
+        std::wofstream file(SINK_FILE);
+        file.imbue(utf8);
+        std::copy(wide.begin(), wide.end(), buffered_ostream_joiner(file, L", "));
+    }
+    report(narrow_ms, codecvt_ms, narrow_text.str() == read_file(SINK_FILE));
+
+    double transcoded_ms = time_run([&]() {
+        std::ofstream sink("/dev/null");
+        std::copy(wide.begin(), wide.end(), buffered_ostream_joiner(sink, L", "));
+    }, "  wide to byte stream (to_utf8)");
+    std::ostringstream transcoded_text;
+    std::copy(wide.begin(), wide.end(), buffered_ostream_joiner(transcoded_text, L", "));
+    report(narrow_ms, transcoded_ms, narrow_text.str() == transcoded_text.str());
+
+    int null_fd = ::open("/dev/null", O_WRONLY);
+    double writev_ms = time_run([&]() {
+        std::copy(wide.begin(), wide.end(), writev_joiner(null_fd, ", "));
+    }, "  wide writev_joiner (to_utf8)");
+    ::close(null_fd);
+    int file_fd = ::open(SINK_FILE, O_WRONLY | O_TRUNC);
+    std::copy(wide.begin(), wide.end(), writev_joiner(file_fd, ", "));
+    ::close(file_fd);
+    report(narrow_ms, writev_ms, narrow_text.str() == read_file(SINK_FILE));
+    std::remove(SINK_FILE);
+    std::cout << "  (speedups are relative to narrow output)" << std::endl;
+}
+
+// Strings longer than the sinks' internal blocks must come out whole
+bool check_long_strings() {
+    std::vector<std::string> parts = {"head", std::string(200000, 'x'), "middle",
+                                      std::string(70000, 'y'), "tail"};
+    std::ostringstream expected;
+    std::copy(parts.begin(), parts.end(), ostream_joiner(expected, ", "));
+
+    int file_fd = ::open(SINK_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    std::copy(parts.begin(), parts.end(), writev_joiner(file_fd, ", "));
+    ::close(file_fd);
+    bool same = expected.str() == read_file(SINK_FILE);
+    std::copy(parts.begin(), parts.end(), mmap_joiner(SINK_FILE, ", "));
+    same = same && expected.str() == read_file(SINK_FILE);
+    std::remove(SINK_FILE);
+    std::cout << "strings longer than a sink block: output "
+              << (same ? "identical" : "DIFFERS") << std::endl;
+    return same;
+}
+
+int main() {
+    const int SIZE = 1000000;
+
+    std::vector<int> ints(SIZE);
+    std::vector<double> doubles(SIZE);
+    for (int i = 0; i < SIZE; ++i) {
+        ints[i] = rand() - RAND_MAX / 2;
+        doubles[i] = rand() / 1000.0;
+    }
+
+    compare(ints, "vector<int>");
+    compare(doubles, "vector<double>");
+    compare_wide(SIZE);
+    return check_long_strings() ? 0 : 1;
+}
@@ -1,88 +1,7 @@
+#include "ostream_joiner.h"
 #include <iostream>
 #include <vector>
-#include <iterator>
-#include <algorithm>
 #include <string>
-#include <string_view>
-
-// ostream_joiner class template
-template<typename T, typename CharT = char, typename Traits = std::char_traits<CharT>>
-class ostream_joiner {
-public:
-    // Iterator traits
-    using iterator_category = std::output_iterator_tag;
-    using value_type = void;
-    using difference_type = void;
-    using pointer = void;
-    using reference = void;
-    using char_type = CharT;
-    using traits_type = Traits;
-    using ostream_type = std::basic_ostream<CharT, Traits>;
-
-    // Constructor taking an output stream and a delimiter
-    ostream_joiner(ostream_type& os, const CharT* delim) 
-        : os_(&os), delimiter_(delim), first_elem_(true) {}
-    
-    // Constructor taking an output stream and any delimiter type that can be streamed
-    template<typename DelimT>
-    ostream_joiner(ostream_type& os, const DelimT& delim)
-        : os_(&os), delimiter_(delim), first_elem_(true) {}
-
-    // operator* returns a reference to self, allowing *oi = value to work
-    ostream_joiner& operator*() { 
-        return *this; 
-    }
-    
-    // Assignment operator - called when *oi = value is executed
-    template<typename U>
-    ostream_joiner& operator=(const U& value) {
-        // If this is not the first element, output the delimiter first
-        if (!first_elem_) {
-            *os_ << delimiter_;
-        } else {
-            first_elem_ = false;
-        }
-        
-        *os_ << value;
-        return *this;
-    }
-
-    // Required for output iterators
-    ostream_joiner& operator++() { return *this; }
-    ostream_joiner& operator++(int) { return *this; }
-
-private:
-    ostream_type* os_;       // Pointer to the output stream
-    std::basic_string<CharT> delimiter_;  // Delimiter between elements
-    bool first_elem_;        // Flag to track if this is the first element
-};
-
-// Deduction guides for C++17 Class Template Argument Deduction (CTAD)
-template<typename CharT, typename Traits>
-ostream_joiner(std::basic_ostream<CharT, Traits>&, const CharT*) 
-    -> ostream_joiner<void, CharT, Traits>;
-
-template<typename CharT, typename Traits, typename DelimT>
-ostream_joiner(std::basic_ostream<CharT, Traits>&, const DelimT&) 
-    -> ostream_joiner<void, CharT, Traits>;
-
-// Helper function to create an ostream_joiner (pre-C++17 alternative to CTAD)
-template<typename CharT, typename Traits, typename DelimT>
-ostream_joiner<void, CharT, Traits> make_ostream_joiner(
-    std::basic_ostream<CharT, Traits>& os, const DelimT& delimiter) {
-    return ostream_joiner<void, CharT, Traits>(os, delimiter);
-}
-
-// Generic operator<< for any vector type
-template<typename T, typename CharT, typename Traits>
-std::basic_ostream<CharT, Traits>& operator<<(
-    std::basic_ostream<CharT, Traits>& os, const std::vector<T>& vec) {
-    
-    os << CharT('[');
-    std::copy(vec.begin(), vec.end(), 
-              ostream_joiner<void, CharT, Traits>(os, CharT(',') + std::basic_string<CharT>(1, CharT(' '))));
-    return os << CharT(']');
-}
 
 int main() {
     std::vector<int> v = {1, 2, 3, 4, 5};
@@ -95,6 +14,10 @@ int main() {
     std::copy(v.begin(), v.end(), ostream_joiner(std::cout, ", "));
     std::cout << std::endl;
     
+    std::cout << "Using buffered_ostream_joiner: ";
+    std::copy(v.begin(), v.end(), buffered_ostream_joiner(std::cout, ", "));
+    std::cout << std::endl;
+    
     std::cout << "Using vector operator<<: " << v << std::endl;
     
     std::vector<double> empty_vec;
@@ -103,11 +26,32 @@ int main() {
     std::vector<std::string> str_vec = {"matcha", "hojicha", "black tea"};
     std::cout << "String vector: " << str_vec << std::endl;
     
+#ifdef JOINER_HAS_FORMAT
+    std::vector<double> prices = {4.5, 5.25, 6.125};
+    std::cout << "Using format_joiner: ";
+    std::copy(prices.begin(), prices.end(), format_joiner<double>(std::cout, ", ", "{:.2f}"));
+    std::cout << std::endl;
+    
+    std::cout << "Using print_range: ";
+    joiner_format::print_range(std::cout, prices, "{:>7.3f}");
+    std::cout << std::endl;
+#endif
+    
+    // Wide text written to a byte stream is encoded to UTF-8 by the joiner
+    std::vector<std::wstring> wide_teas = {L"matcha", L"h\u014djicha", L"\u7389\u9732"};
+    std::cout << "Wide strings as UTF-8: ";
+    std::copy(wide_teas.begin(), wide_teas.end(), buffered_ostream_joiner(std::cout, L", "));
+    std::cout << std::endl;
+    
     std::vector<int> wv = {6, 7, 8, 9, 10};
     std::wcout << L"Wide char output: ";
     std::copy(wv.begin(), wv.end(), ostream_joiner(std::wcout, L", "));
     std::wcout << std::endl;
     
+    std::wcout << L"Wide buffered output: ";
+    std::copy(wv.begin(), wv.end(), buffered_ostream_joiner(std::wcout, L", "));
+    std::wcout << std::endl;
+    
     std::wcout << L"Wide char vector operator<<: " << wv << std::endl;
     
     return 0;
@@ -0,0 +1,493 @@
+#ifndef OSTREAM_JOINER_H
+#define OSTREAM_JOINER_H
+
+#include <iostream>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <memory>
+#include <type_traits>
+#include <atomic>
+#include <exception>
+#include <sstream>
+#include <thread>
+#include "format_backend.h"
+#include "utf_transcode.h"
+
+// ostream_joiner class template
+template<typename T, typename CharT = char, typename Traits = std::char_traits<CharT>>
+class ostream_joiner {
+public:
+    // Iterator traits
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = void;
+    using pointer = void;
+    using reference = void;
+    using char_type = CharT;
+    using traits_type = Traits;
+    using ostream_type = std::basic_ostream<CharT, Traits>;
+
+    // Constructor taking an output stream and a delimiter
+    ostream_joiner(ostream_type& os, const CharT* delim) 
+        : os_(&os), delimiter_(delim), first_elem_(true) {}
+    
+    // Constructor taking an output stream and any delimiter type that can be streamed
+    template<typename DelimT>
+    ostream_joiner(ostream_type& os, const DelimT& delim)
+        : os_(&os), delimiter_(delim), first_elem_(true) {}
+
+    // operator* returns a reference to self, allowing *oi = value to work
+    ostream_joiner& operator*() { 
+        return *this; 
+    }
+    
+    // Assignment operator - called when *oi = value is executed
+    template<typename U>
+    ostream_joiner& operator=(const U& value) {
+        // If this is not the first element, output the delimiter first
+        if (!first_elem_) {
+            *os_ << delimiter_;
+        } else {
+            first_elem_ = false;
+        }
+        
+        *os_ << value;
+        return *this;
+    }
+
+    // Required for output iterators
+    ostream_joiner& operator++() { return *this; }
+    ostream_joiner& operator++(int) { return *this; }
+
+private:
+    ostream_type* os_;       // Pointer to the output stream
+    std::basic_string<CharT> delimiter_;  // Delimiter between elements
+    bool first_elem_;        // Flag to track if this is the first element
+};
+
+// Deduction guides for C++17 Class Template Argument Deduction (CTAD)
+template<typename CharT, typename Traits>
+ostream_joiner(std::basic_ostream<CharT, Traits>&, const CharT*) 
+    -> ostream_joiner<void, CharT, Traits>;
+
+template<typename CharT, typename Traits, typename DelimT>
+ostream_joiner(std::basic_ostream<CharT, Traits>&, const DelimT&) 
+    -> ostream_joiner<void, CharT, Traits>;
+
+// Helper function to create an ostream_joiner (pre-C++17 alternative to CTAD)
+template<typename CharT, typename Traits, typename DelimT>
+ostream_joiner<void, CharT, Traits> make_ostream_joiner(
+    std::basic_ostream<CharT, Traits>& os, const DelimT& delimiter) {
+    return ostream_joiner<void, CharT, Traits>(os, delimiter);
+}
+
+// Arithmetic types that operator<< prints as numbers
+template<typename U>
+inline constexpr bool joiner_is_number_v = std::is_arithmetic_v<U> && !std::is_same_v<U, bool>
+    && !std::is_same_v<U, char> && !std::is_same_v<U, signed char>
+    && !std::is_same_v<U, unsigned char> && !std::is_same_v<U, wchar_t>
+    && !std::is_same_v<U, char8_t> && !std::is_same_v<U, char16_t>
+    && !std::is_same_v<U, char32_t>;
+
+// buffered_ostream_joiner class template
+// Same interface as ostream_joiner, but numbers are formatted with
+// std::to_chars into a block buffer that is handed to the stream buffer
+// with sputn once full, bypassing the sentry and locale on every element.
+// Floating point output matches operator<< with the stream's precision;
+// other stream flags (width, base, ...) are ignored. Types with no fast
+// path fall back to operator<<.
+// Like std::ostream_iterator, the delimiter is not copied and must outlive
+// the joiner. Copies share one buffer, which is flushed when the last copy
+// is destroyed or flush() is called.
+// A joiner of wide (or char8_t) characters can also write to a narrow
+// stream: each full buffer is then encoded to UTF-8 by joiner_utf::to_utf8
+// and handed to the stream buffer as bytes, instead of going through the
+// wide stream's codecvt one character at a time.
+//     std::copy(v.begin(), v.end(), buffered_ostream_joiner(std::cout, L", "));
+template<typename T, typename CharT = char, typename Traits = std::char_traits<CharT>>
+class buffered_ostream_joiner {
+public:
+    // Iterator traits
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = void;
+    using pointer = void;
+    using reference = void;
+    using char_type = CharT;
+    using traits_type = Traits;
+    using ostream_type = std::basic_ostream<CharT, Traits>;
+
+    static constexpr std::size_t buffer_size = 1 << 16;
+
+    buffered_ostream_joiner(ostream_type& os, std::basic_string_view<CharT, Traits> delim)
+        : state_(std::make_shared<state>(os, delim)) {}
+
+    // Writes UTF-8 to a byte stream
+    buffered_ostream_joiner(std::ostream& bytes, std::basic_string_view<CharT, Traits> delim)
+        requires joiner_utf::is_utf_char_v<CharT>
+        : state_(std::make_shared<state>(bytes, delim)) {}
+
+    buffered_ostream_joiner& operator*() { 
+        return *this; 
+    }
+
+    template<typename U>
+    buffered_ostream_joiner& operator=(const U& value) {
+        state_->put(value);
+        return *this;
+    }
+
+    buffered_ostream_joiner& operator++() { return *this; }
+    buffered_ostream_joiner& operator++(int) { return *this; }
+
+    // Writes any buffered output to the stream
+    void flush() { state_->flush(); }
+
+private:
+    // Room left in the buffer before each element; enough for any number
+    static constexpr std::size_t max_number_size = 64;
+
+    struct state {
+        ostream_type* os_ = nullptr;
+        std::ostream* utf8_os_ = nullptr; // set in UTF-8 mode instead of os_
+        std::unique_ptr<char[]> utf8_;
+        std::basic_string_view<CharT, Traits> delimiter_;
+        int precision_;
+        bool first_elem_ = true;
+        std::size_t used_ = 0;
+        CharT buffer_[buffer_size];
+
+        state(ostream_type& os, std::basic_string_view<CharT, Traits> delim)
+            : os_(&os), delimiter_(delim), precision_(static_cast<int>(os.precision())) {}
+
+        state(std::ostream& bytes, std::basic_string_view<CharT, Traits> delim)
+            requires joiner_utf::is_utf_char_v<CharT>
+            : utf8_os_(&bytes), utf8_(new char[joiner_utf::max_utf8_size<CharT>(buffer_size)]),
+              delimiter_(delim), precision_(static_cast<int>(bytes.precision())) {}
+
+        ~state() { flush(true); }
+
+        // Unless this is the last flush, a UTF-16 high surrogate ending the
+        // buffer stays behind to be encoded with the rest of its pair
+        void flush(bool last = false) {
+            if (used_ == 0) {
+                return;
+            }
+            if constexpr (joiner_utf::is_utf_char_v<CharT>) {
+                if (utf8_os_) {
+                    auto [read, written] = joiner_utf::to_utf8(buffer_, used_, utf8_.get(), last);
+                    if (utf8_os_->rdbuf()->sputn(utf8_.get(), static_cast<std::streamsize>(written))
+                        != static_cast<std::streamsize>(written)) {
+                        utf8_os_->setstate(std::ios_base::badbit);
+                    }
+                    Traits::move(buffer_, buffer_ + read, used_ - read);
+                    used_ -= read;
+                    return;
+                }
+            }
+            if (os_->rdbuf()->sputn(buffer_, used_) != static_cast<std::streamsize>(used_)) {
+                os_->setstate(std::ios_base::badbit);
+            }
+            used_ = 0;
+        }
+
+        void append(const CharT* s, std::size_t n) {
+            if (used_ + n > buffer_size) {
+                flush();
+                if (n > buffer_size && os_) {
+                    os_->rdbuf()->sputn(s, n);
+                    return;
+                }
+                // UTF-8 mode: long text goes through the buffer piece by piece
+                while (used_ + n > buffer_size) {
+                    std::size_t piece = buffer_size - used_;
+                    Traits::copy(buffer_ + used_, s, piece);
+                    used_ += piece;
+                    s += piece;
+                    n -= piece;
+                    flush();
+                }
+            }
+            Traits::copy(buffer_ + used_, s, n);
+            used_ += n;
+        }
+
+        // Output of operator<<, for types with no fast path
+        template<typename U>
+        void put_streamed(const U& value) {
+            if (os_) {
+                flush();
+                *os_ << value;
+            } else {
+                std::basic_ostringstream<CharT, Traits> text;
+                text.precision(precision_);
+                text << value;
+                std::basic_string<CharT, Traits> s = std::move(text).str();
+                append(s.data(), s.size());
+            }
+        }
+
+        template<typename U>
+        void put(const U& value) {
+            if constexpr (joiner_is_number_v<U>) {
+                // One capacity check covers both the delimiter and the number
+                if (used_ + delimiter_.size() + max_number_size <= buffer_size) {
+                    put_delimiter();
+                } else {
+                    append_delimiter();
+                    if (used_ + max_number_size > buffer_size) {
+                        flush();
+                    }
+                }
+                put_number(value);
+            } else if constexpr (std::is_same_v<U, CharT>) {
+                append_delimiter();
+                append(&value, 1);
+            } else if constexpr (std::is_convertible_v<const U&, std::basic_string_view<CharT, Traits>>) {
+                append_delimiter();
+                std::basic_string_view<CharT, Traits> sv = value;
+                append(sv.data(), sv.size());
+            } else {
+                append_delimiter();
+                put_streamed(value);
+            }
+        }
+
+        // Caller guarantees room for the delimiter
+        void put_delimiter() {
+            if (!first_elem_) {
+                for (CharT c : delimiter_) {
+                    buffer_[used_++] = c;
+                }
+            } else {
+                first_elem_ = false;
+            }
+        }
+
+        void append_delimiter() {
+            if (!first_elem_) {
+                append(delimiter_.data(), delimiter_.size());
+            } else {
+                first_elem_ = false;
+            }
+        }
+
+        template<typename U>
+        void put_number(const U& value) {
+            char* first;
+            char* last;
+            char narrow[max_number_size];
+            if constexpr (std::is_same_v<CharT, char>) {
+                first = buffer_ + used_;
+                last = first + max_number_size;
+            } else {
+                first = narrow;
+                last = narrow + max_number_size;
+            }
+
+            std::to_chars_result result;
+            if constexpr (std::is_floating_point_v<U>) {
+                result = std::to_chars(first, last, value, std::chars_format::general, precision_);
+            } else {
+                result = std::to_chars(first, last, value);
+            }
+            if (result.ec != std::errc{}) {
+                // Only reachable with a precision too large for the scratch space
+                put_streamed(value);
+                return;
+            }
+
+            if constexpr (std::is_same_v<CharT, char>) {
+                used_ += result.ptr - first;
+            } else {
+                for (char* c = first; c != result.ptr; ++c) {
+                    buffer_[used_++] = static_cast<CharT>(*c);
+                }
+            }
+        }
+    };
+
+    std::shared_ptr<state> state_;
+};
+
+template<typename CharT, typename Traits>
+buffered_ostream_joiner(std::basic_ostream<CharT, Traits>&, const CharT*) 
+    -> buffered_ostream_joiner<void, CharT, Traits>;
+
+template<typename CharT, typename Traits>
+buffered_ostream_joiner(std::basic_ostream<CharT, Traits>&, std::basic_string_view<CharT, Traits>) 
+    -> buffered_ostream_joiner<void, CharT, Traits>;
+
+// Wide text to a byte stream, as UTF-8
+template<typename CharT>
+    requires joiner_utf::is_utf_char_v<CharT>
+buffered_ostream_joiner(std::ostream&, const CharT*) -> buffered_ostream_joiner<void, CharT>;
+
+template<typename CharT, typename Traits>
+    requires joiner_utf::is_utf_char_v<CharT>
+buffered_ostream_joiner(std::ostream&, std::basic_string_view<CharT, Traits>)
+    -> buffered_ostream_joiner<void, CharT, Traits>;
+
+// Generic operator<< for any vector type
+template<typename T, typename CharT, typename Traits>
+std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& os, const std::vector<T>& vec) {
+    
+#ifdef JOINER_HAS_FORMAT
+    // Format the whole vector in memory and write it once when the output
+    // would be the same as going element by element
+    if constexpr (std::is_same_v<CharT, char> && std::is_same_v<Traits, std::char_traits<char>>
+                  && joiner_format::matches_ostream_v<T>) {
+        if (joiner_format::has_default_format(os)) {
+            joiner_format::buffer out;
+            out.push_back('[');
+            for (std::size_t i = 0; i < vec.size(); ++i) {
+                if (i != 0) {
+                    joiner_format::append(out, ", ");
+                }
+                joiner_format::format_default(out, vec[i], static_cast<int>(os.precision()));
+            }
+            out.push_back(']');
+            joiner_format::write(os, out);
+            return os;
+        }
+    }
+#endif
+
+    os << CharT('[');
+    std::copy(vec.begin(), vec.end(), 
+              ostream_joiner<void, CharT, Traits>(os, CharT(',') + std::basic_string<CharT>(1, CharT(' '))));
+    return os << CharT(']');
+}
+
+// Formats vec[first, last) exactly as the vector operator<< would print
+// those elements on os. Chunks after the first start with the delimiter.
+template<typename T, typename CharT, typename Traits>
+std::basic_string<CharT, Traits> format_vector_chunk(
+    const std::basic_ostream<CharT, Traits>& os, const std::vector<T>& vec,
+    std::size_t first, std::size_t last) {
+
+#ifdef JOINER_HAS_FORMAT
+    if constexpr (std::is_same_v<CharT, char> && std::is_same_v<Traits, std::char_traits<char>>
+                  && joiner_format::matches_ostream_v<T>) {
+        if (joiner_format::has_default_format(os)) {
+            joiner_format::buffer out;
+            for (std::size_t i = first; i < last; ++i) {
+                if (i != 0) {
+                    joiner_format::append(out, ", ");
+                }
+                joiner_format::format_default(out, vec[i], static_cast<int>(os.precision()));
+            }
+            return std::string(out.data(), out.size());
+        }
+    }
+#endif
+
+    const std::basic_string<CharT, Traits> delimiter{CharT(','), CharT(' ')};
+    std::basic_ostringstream<CharT, Traits> chunk;
+    chunk.copyfmt(os);
+    if (first != 0) {
+        chunk << delimiter;
+    }
+    std::copy(vec.begin() + first, vec.begin() + last,
+              ostream_joiner<void, CharT, Traits>(chunk, delimiter));
+    return std::move(chunk).str();
+}
+
+// Parallel mode for the vector operator<<: os << in_parallel(vec)
+// Splits the vector into chunks that a pool of worker threads format into
+// their own buffers, while the calling thread writes finished chunks to
+// the stream in order. The output is byte-identical to os << vec.
+template<typename T>
+struct parallel_vector {
+    const std::vector<T>& vec;
+    unsigned threads;
+};
+
+template<typename T>
+parallel_vector<T> in_parallel(const std::vector<T>& vec,
+                               unsigned threads = std::thread::hardware_concurrency()) {
+    return parallel_vector<T>{vec, threads == 0 ? 1 : threads};
+}
+
+template<typename T, typename CharT, typename Traits>
+std::basic_ostream<CharT, Traits>& operator<<(
+    std::basic_ostream<CharT, Traits>& os, const parallel_vector<T>& pv) {
+
+    // Below this many elements per chunk, threads cost more than they save
+    const std::size_t min_chunk = 16384;
+    const std::vector<T>& vec = pv.vec;
+    // A width would pad the '[' only; leave that case to the serial path
+    if (pv.threads <= 1 || vec.size() < 2 * min_chunk || os.width() != 0) {
+        return os << vec;
+    }
+
+    // Workers read the format state from a private copy, so they never
+    // touch os (or flush a stream tied to it) while this thread writes
+    std::basic_ostringstream<CharT, Traits> format_state;
+    format_state.copyfmt(os);
+    format_state.tie(nullptr);
+
+    std::size_t chunk_size = std::max(min_chunk, vec.size() / (pv.threads * 4));
+    std::size_t chunk_count = (vec.size() + chunk_size - 1) / chunk_size;
+
+    struct chunk {
+        std::basic_string<CharT, Traits> text;
+        std::exception_ptr error;
+        std::atomic<bool> ready{false};
+    };
+    std::vector<chunk> chunks(chunk_count);
+    std::atomic<std::size_t> next{0};
+
+    // A worker that fails hands its exception to the writing thread
+    // through the chunk, instead of letting it end the process
+    auto work = [&]() {
+        for (std::size_t c; (c = next.fetch_add(1, std::memory_order_relaxed)) < chunk_count; ) {
+            std::size_t first = c * chunk_size;
+            std::size_t last = std::min(first + chunk_size, vec.size());
+            try {
+                chunks[c].text = format_vector_chunk(format_state, vec, first, last);
+            } catch (...) {
+                chunks[c].error = std::current_exception();
+            }
+            chunks[c].ready.store(true, std::memory_order_release);
+            chunks[c].ready.notify_one();
+        }
+    };
+
+    // However this function is left, workers stop taking chunks and are
+    // joined before the chunks they write to go away
+    std::vector<std::thread> pool;
+    struct join_guard {
+        std::vector<std::thread>& pool;
+        std::atomic<std::size_t>& next;
+        std::size_t chunk_count;
+        ~join_guard() {
+            next.store(chunk_count, std::memory_order_relaxed);
+            for (std::thread& t : pool) {
+                t.join();
+            }
+        }
+    } guard{pool, next, chunk_count};
+    for (unsigned i = 0; i < std::min<std::size_t>(pv.threads, chunk_count); ++i) {
+        pool.emplace_back(work);
+    }
+
+    os << CharT('[');
+    for (chunk& c : chunks) {
+        c.ready.wait(false, std::memory_order_acquire);
+        if (c.error) {
+            std::rethrow_exception(c.error);
+        }
+        os.write(c.text.data(), static_cast<std::streamsize>(c.text.size()));
+        // Release each chunk as soon as it is written
+        std::basic_string<CharT, Traits>().swap(c.text);
+    }
+    return os << CharT(']');
+}
+
+#endif
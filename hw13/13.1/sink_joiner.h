@@ -0,0 +1,389 @@
+#ifndef SINK_JOINER_H
+#define SINK_JOINER_H
+
+#include "ostream_joiner.h"
+#include "utf_transcode.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Joiners that bypass iostreams entirely and format straight into their
+// destination: a caller-supplied span, a growing memory-mapped file, or a
+// file descriptor written with batched writev calls. They keep the
+// ostream_joiner interface (*it = value; ++it) so std::copy works
+// unchanged. Numbers are formatted with std::to_chars exactly as operator<<
+// prints them on a default-configured stream; strings are copied as is,
+// and wide or char8_t strings are encoded to UTF-8 (see utf_transcode.h)
+// straight into the sink.
+
+namespace joiner_sink {
+
+[[noreturn]] inline void throw_errno(const char* what) {
+    throw std::system_error{errno, std::generic_category(), what};
+}
+
+// Sinks hand out room for n bytes with reserve(n) and are told how much
+// of it was used with commit(). reserve returns nullptr if the sink can
+// never provide that much room.
+
+// Writes into a fixed caller-owned buffer
+class span_sink {
+public:
+    using target_type = std::span<char>;
+
+    explicit span_sink(std::span<char> out) : out_(out) {}
+
+    char* reserve(std::size_t n) {
+        if (out_.size() - used_ < n) {
+            return nullptr;
+        }
+        return out_.data() + used_;
+    }
+    void commit(std::size_t n) { used_ += n; }
+    void flush() {}
+
+    std::size_t size() const { return used_; }
+
+private:
+    std::span<char> out_;
+    std::size_t used_ = 0;
+};
+
+// Writes into a shared mapping of a file, doubling the file and the
+// mapping whenever it runs out of room. The file is truncated to the
+// bytes actually written when the sink is destroyed.
+class mmap_sink {
+public:
+    using target_type = const std::string&;
+
+    static constexpr std::size_t initial_capacity = 1 << 20;
+
+    explicit mmap_sink(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) {
+            throw_errno("mmap_joiner: open failed");
+        }
+        remap(initial_capacity);
+    }
+
+    mmap_sink(const mmap_sink&) = delete;
+    mmap_sink& operator=(const mmap_sink&) = delete;
+
+    ~mmap_sink() {
+        if (data_) {
+            ::munmap(data_, capacity_);
+        }
+        if (fd_ >= 0) {
+            // Errors cannot be reported from a destructor
+            [[maybe_unused]] int rc = ::ftruncate(fd_, static_cast<off_t>(used_));
+            ::close(fd_);
+        }
+    }
+
+    char* reserve(std::size_t n) {
+        if (capacity_ - used_ < n) {
+            std::size_t capacity = capacity_;
+            while (capacity - used_ < n) {
+                capacity *= 2;
+            }
+            remap(capacity);
+        }
+        return data_ + used_;
+    }
+    void commit(std::size_t n) { used_ += n; }
+
+    // Written bytes are already in the page cache
+    void flush() {}
+
+    std::size_t size() const { return used_; }
+
+private:
+    void remap(std::size_t capacity) {
+        if (data_) {
+            ::munmap(data_, capacity_);
+            data_ = nullptr;
+        }
+        if (::ftruncate(fd_, static_cast<off_t>(capacity)) != 0) {
+            throw_errno("mmap_joiner: ftruncate failed");
+        }
+        void* p = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            throw_errno("mmap_joiner: mmap failed");
+        }
+        data_ = static_cast<char*>(p);
+        capacity_ = capacity;
+    }
+
+    int fd_ = -1;
+    char* data_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t used_ = 0;
+};
+
+// Formats into a set of fixed-size blocks and hands them to the kernel
+// with a single writev call once all batch_blocks are full, so large
+// outputs cost one system call per batch and no copy into one contiguous
+// buffer. Strings longer than a block skip the blocks and go to writev as
+// their own iovec.
+class writev_sink {
+public:
+    using target_type = int;
+
+    static constexpr std::size_t block_size = 1 << 16;
+    static constexpr std::size_t batch_blocks = IOV_MAX < 64 ? IOV_MAX : 64;
+
+    explicit writev_sink(int fd) : fd_(fd), blocks_(batch_blocks), lengths_(batch_blocks) {
+        blocks_[0] = std::make_unique<char[]>(block_size);
+    }
+
+    writev_sink(const writev_sink&) = delete;
+    writev_sink& operator=(const writev_sink&) = delete;
+
+    // Errors cannot be reported from a destructor
+    ~writev_sink() {
+        try {
+            flush();
+        } catch (...) {
+        }
+    }
+
+    char* reserve(std::size_t n) {
+        if (n > block_size) {
+            return nullptr;
+        }
+        if (block_size - used_ < n) {
+            lengths_[current_] = used_;
+            used_ = 0;
+            if (++current_ == batch_blocks) {
+                write_blocks();
+            }
+            if (!blocks_[current_]) {
+                blocks_[current_] = std::make_unique<char[]>(block_size);
+            }
+        }
+        return blocks_[current_].get() + used_;
+    }
+    void commit(std::size_t n) { used_ += n; written_ += n; }
+
+    void flush() {
+        lengths_[current_] = used_;
+        ++current_;
+        write_blocks();
+        used_ = 0;
+    }
+
+    // Writes n bytes too large for any block: the blocks filled so far and
+    // then the bytes themselves, straight from data, in one writev
+    void write_through(const char* data, std::size_t n) {
+        lengths_[current_] = used_;
+        ++current_;
+        write_blocks(iovec{const_cast<char*>(data), n});
+        used_ = 0;
+        written_ += n;
+    }
+
+    std::size_t size() const { return written_; }
+
+private:
+    // Writes blocks [0, current_), then extra if it is not empty, and
+    // starts over at block 0
+    void write_blocks(iovec extra = {nullptr, 0}) {
+        iovec iov[batch_blocks + 1];
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < current_; ++i) {
+            if (lengths_[i] != 0) {
+                iov[count++] = iovec{blocks_[i].get(), lengths_[i]};
+            }
+        }
+        if (extra.iov_len != 0) {
+            iov[count++] = extra;
+        }
+        current_ = 0;
+
+        iovec* next = iov;
+        while (count != 0) {
+            ssize_t n = ::writev(fd_, next, static_cast<int>(count));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw_errno("writev_joiner: writev failed");
+            }
+            auto done = static_cast<std::size_t>(n);
+            while (count != 0 && done >= next->iov_len) {
+                done -= next->iov_len;
+                ++next;
+                --count;
+            }
+            if (count != 0) {
+                next->iov_base = static_cast<char*>(next->iov_base) + done;
+                next->iov_len -= done;
+            }
+        }
+    }
+
+    int fd_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::vector<std::size_t> lengths_;
+    std::size_t current_ = 0;
+    std::size_t used_ = 0;
+    std::size_t written_ = 0;
+};
+
+} // namespace joiner_sink
+
+// sink_joiner class template
+// Copies share one sink; the last copy to be destroyed flushes it.
+template<typename Sink>
+class sink_joiner {
+public:
+    // Iterator traits
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = void;
+    using pointer = void;
+    using reference = void;
+
+    // Room reserved for one formatted number
+    static constexpr std::size_t max_number_size = 64;
+
+    sink_joiner(typename Sink::target_type target, std::string_view delim)
+        : state_(std::make_shared<state>(target, delim)) {}
+
+    sink_joiner& operator*() {
+        return *this;
+    }
+
+    template<typename U>
+    sink_joiner& operator=(const U& value) {
+        state_->put(value);
+        return *this;
+    }
+
+    sink_joiner& operator++() { return *this; }
+    sink_joiner& operator++(int) { return *this; }
+
+    void flush() { state_->sink_.flush(); }
+
+    // Bytes written so far
+    std::size_t size() const { return state_->sink_.size(); }
+
+private:
+    struct state {
+        Sink sink_;
+        std::string_view delimiter_;
+        bool first_elem_ = true;
+
+        state(typename Sink::target_type target, std::string_view delim)
+            : sink_(target), delimiter_(delim) {}
+
+        template<typename U>
+        void put(const U& value) {
+            if constexpr (joiner_is_number_v<U>) {
+                std::size_t delim = first_elem_ ? 0 : delimiter_.size();
+                if (char* first = sink_.reserve(delim + max_number_size)) {
+                    std::char_traits<char>::copy(first, delimiter_.data(), delim);
+                    char* end = format_number(first + delim, value);
+                    sink_.commit(end - first);
+                    first_elem_ = false;
+                } else {
+                    // Not enough room for the worst case; format aside and
+                    // copy only what is needed
+                    char scratch[max_number_size];
+                    char* end = format_number(scratch, value);
+                    put_text(std::string_view(scratch, end - scratch));
+                }
+            } else if constexpr (std::is_same_v<U, char>) {
+                put_text(std::string_view(&value, 1));
+            } else if constexpr (!std::is_void_v<joiner_utf::utf_text_char_t<U>>) {
+                using wide_char = joiner_utf::utf_text_char_t<U>;
+                if constexpr (std::is_same_v<U, wide_char>) {
+                    put_wide_text(std::basic_string_view<wide_char>(&value, 1));
+                } else {
+                    put_wide_text(std::basic_string_view<wide_char>(value));
+                }
+            } else {
+                static_assert(std::is_convertible_v<const U&, std::string_view>,
+                              "sink_joiner writes numbers and strings only");
+                put_text(std::string_view(value));
+            }
+        }
+
+        // Writes at most max_number_size characters starting at first
+        template<typename U>
+        static char* format_number(char* first, const U& value) {
+            if constexpr (std::is_floating_point_v<U>) {
+                // Same text as operator<< with the default precision of 6
+                return std::to_chars(first, first + max_number_size, value,
+                                     std::chars_format::general, 6).ptr;
+            } else {
+                return std::to_chars(first, first + max_number_size, value).ptr;
+            }
+        }
+
+        void put_text(std::string_view text) {
+            std::size_t delim = first_elem_ ? 0 : delimiter_.size();
+            char* first = sink_.reserve(delim + text.size());
+            if (!first) {
+                // Sinks that can take text larger than their buffers
+                // (writev_sink) are handed it directly
+                if constexpr (requires { sink_.write_through(text.data(), text.size()); }) {
+                    if (char* d = delim ? sink_.reserve(delim) : nullptr) {
+                        std::char_traits<char>::copy(d, delimiter_.data(), delim);
+                        sink_.commit(delim);
+                    }
+                    sink_.write_through(text.data(), text.size());
+                    first_elem_ = false;
+                    return;
+                }
+                throw std::length_error{"sink_joiner: no room for element"};
+            }
+            std::char_traits<char>::copy(first, delimiter_.data(), delim);
+            std::char_traits<char>::copy(first + delim, text.data(), text.size());
+            sink_.commit(delim + text.size());
+            first_elem_ = false;
+        }
+
+        // Encodes text wide_piece code units at a time, so no sink is asked
+        // for more room than one piece can take
+        template<typename WideChar>
+        void put_wide_text(std::basic_string_view<WideChar> text) {
+            constexpr std::size_t wide_piece = 4096;
+            std::size_t delim = first_elem_ ? 0 : delimiter_.size();
+            do {
+                std::size_t n = std::min(text.size(), wide_piece);
+                char* first = sink_.reserve(delim + joiner_utf::max_utf8_size<WideChar>(n));
+                if (!first) {
+                    throw std::length_error{"sink_joiner: no room for element"};
+                }
+                std::char_traits<char>::copy(first, delimiter_.data(), delim);
+                auto [read, written] = joiner_utf::to_utf8(text.data(), n, first + delim, n == text.size());
+                sink_.commit(delim + written);
+                text.remove_prefix(read);
+                delim = 0;
+            } while (!text.empty());
+            first_elem_ = false;
+        }
+    };
+
+    std::shared_ptr<state> state_;
+};
+
+using span_joiner = sink_joiner<joiner_sink::span_sink>;
+using mmap_joiner = sink_joiner<joiner_sink::mmap_sink>;
+using writev_joiner = sink_joiner<joiner_sink::writev_sink>;
+
+#endif
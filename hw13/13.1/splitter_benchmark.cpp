@@ -0,0 +1,102 @@
+#include "ostream_joiner.h"
+#include "istream_splitter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// Round trip: a million values written with buffered_ostream_joiner are
+// read back with an istream >> loop, buffer_splitter, a mapped_file and
+// istream_splitter, and each result is checked against the original.
+
+// In the temporary directory, so an interrupted run leaves nothing in the tree
+const std::string ROUND_TRIP_PATH = (std::filesystem::temp_directory_path()
+    / ("splitter_benchmark." + std::to_string(::getpid()) + ".out")).string();
+const char* ROUND_TRIP_FILE = ROUND_TRIP_PATH.c_str();
+
+template<typename Func>
+double time_run(Func func, const std::string& name) {
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> duration = end - start;
+    std::cout << name << " took " << duration.count() << " ms" << std::endl;
+    return duration.count();
+}
+
+void report(double baseline_ms, double ms, bool same) {
+    std::cout << "  speedup: " << baseline_ms / ms << "x, values "
+              << (same ? "identical" : "DIFFER") << std::endl;
+}
+
+template<typename T>
+void round_trip(const std::vector<T>& data, const std::string& label) {
+    std::ostringstream os;
+    std::copy(data.begin(), data.end(), buffered_ostream_joiner(os, ", "));
+    std::string text = os.str();
+    std::ofstream(ROUND_TRIP_FILE) << text;
+
+    std::cout << label << " with " << data.size() << " elements (" << text.size() << " bytes):" << std::endl;
+
+    std::vector<T> loop;
+    double loop_ms = time_run([&]() {
+        std::istringstream is(text);
+        T value;
+        char separator;
+        while (is >> value) {
+            loop.push_back(value);
+            is >> separator;
+        }
+    }, "  istream >> loop");
+    report(loop_ms, loop_ms, loop == data);
+
+    std::vector<T> split;
+    double split_ms = time_run([&]() {
+        for (const T& value : buffer_splitter<T>(text, ", ")) {
+            split.push_back(value);
+        }
+    }, "  buffer_splitter");
+    report(loop_ms, split_ms, split == data);
+
+    std::vector<T> mapped;
+    double mapped_ms = time_run([&]() {
+        mapped_file file(ROUND_TRIP_FILE);
+        for (const T& value : buffer_splitter<T>(file.view(), ", ")) {
+            mapped.push_back(value);
+        }
+    }, "  buffer_splitter on mapped_file");
+    report(loop_ms, mapped_ms, mapped == data);
+
+    std::vector<T> streamed;
+    double streamed_ms = time_run([&]() {
+        std::ifstream in(ROUND_TRIP_FILE);
+        for (const T& value : istream_splitter<T>(in, ", ")) {
+            streamed.push_back(value);
+        }
+    }, "  istream_splitter on ifstream");
+    report(loop_ms, streamed_ms, streamed == data);
+
+    std::remove(ROUND_TRIP_FILE);
+}
+
+int main() {
+    const int SIZE = 1000000;
+
+    std::vector<int> ints(SIZE);
+    std::vector<long> longs(SIZE);
+    for (int i = 0; i < SIZE; ++i) {
+        ints[i] = rand() - RAND_MAX / 2;
+        longs[i] = static_cast<long>(rand()) * rand();
+    }
+
+    round_trip(ints, "vector<int>");
+    round_trip(longs, "vector<long>");
+    return 0;
+}
@@ -0,0 +1,248 @@
+#ifndef UTF_TRANSCODE_H
+#define UTF_TRANSCODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// UTF-8 encoding of wide text for the joiners' byte sinks. char8_t text is
+// already UTF-8 and is copied; char16_t text (and wchar_t where it is 16
+// bits) is UTF-16; char32_t text (and wchar_t where it is 32 bits) is
+// UTF-32. Runs of ASCII, the bulk of any report, are narrowed 16 or 32
+// code units at a time with SSE2/AVX2; the code points between them are
+// encoded one at a time. Lone surrogates and values past U+10FFFF are
+// written as U+FFFD.
+
+namespace joiner_utf {
+
+template<typename CharT>
+inline constexpr bool is_utf_char_v = std::is_same_v<CharT, wchar_t> || std::is_same_v<CharT, char8_t>
+    || std::is_same_v<CharT, char16_t> || std::is_same_v<CharT, char32_t>;
+
+// Most UTF-8 bytes that n code units of CharT can take
+template<typename CharT>
+constexpr std::size_t max_utf8_size(std::size_t n) {
+    return sizeof(CharT) == 1 ? n : sizeof(CharT) == 2 ? 3 * n : 4 * n;
+}
+
+struct transcode_result {
+    std::size_t read;    // code units consumed
+    std::size_t written; // bytes produced
+};
+
+namespace detail {
+
+inline char* put_code_point(char* out, char32_t cp) {
+    if (cp < 0x80) {
+        *out++ = static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (cp >> 6));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *out++ = static_cast<char>(0xE0 | (cp >> 12));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        *out++ = static_cast<char>(0xF0 | (cp >> 18));
+        *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+inline constexpr char32_t replacement = 0xFFFD;
+
+// Encodes the code point at in. Returns false, consuming nothing, for a
+// high surrogate that ends the input and may be completed by the next call.
+template<typename Unit>
+bool encode_one(const Unit*& in, const Unit* last, char*& out, bool final_chunk) {
+    char32_t c = static_cast<char32_t>(*in);
+    if constexpr (sizeof(Unit) == 2) {
+        if (c >= 0xD800 && c < 0xDC00) {
+            if (in + 1 == last) {
+                if (!final_chunk) {
+                    return false;
+                }
+                c = replacement;
+            } else if (char32_t low = static_cast<char32_t>(in[1]); low >= 0xDC00 && low < 0xE000) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                ++in;
+            } else {
+                c = replacement;
+            }
+        } else if (c >= 0xDC00 && c < 0xE000) {
+            c = replacement;
+        }
+    } else {
+        if ((c >= 0xD800 && c < 0xE000) || c > 0x10FFFF) {
+            c = replacement;
+        }
+    }
+    ++in;
+    out = put_code_point(out, c);
+    return true;
+}
+
+// Narrows the next block code units to bytes and returns how many of
+// them, from the first, are ASCII; only that many of the stored bytes are
+// valid. The caller guarantees block units of input and block bytes of
+// room.
+#if defined(__AVX2__)
+inline constexpr std::size_t block = 32;
+
+inline std::size_t narrow_ascii(const char16_t* in, char* out) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 16));
+    // Packing works per 128-bit lane; restore the order of the quadwords
+    __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), bytes);
+    const __m256i high = _mm256_set1_epi16(static_cast<short>(0xFF80));
+    const __m256i zero = _mm256_setzero_si256();
+    auto ascii_a = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(a, high), zero)));
+    auto ascii_b = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(b, high), zero)));
+    std::uint64_t ascii = ascii_a | (std::uint64_t(ascii_b) << 32); // two bits per unit
+    return ascii == ~std::uint64_t(0) ? block : static_cast<std::size_t>(__builtin_ctzll(~ascii)) / 2;
+}
+
+inline std::size_t narrow_ascii(const char32_t* in, char* out) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 8));
+    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 16));
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 24));
+    const __m256i high = _mm256_set1_epi32(static_cast<int>(0xFFFFFF80));
+    const __m256i zero = _mm256_setzero_si256();
+    auto ascii_of = [&](__m256i v) {
+        return static_cast<std::uint32_t>(_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(v, high), zero))));
+    };
+    std::uint32_t ascii = ascii_of(a) | (ascii_of(b) << 8) | (ascii_of(c) << 16) | (ascii_of(d) << 24);
+    // Signed packing only saturates units that are not ASCII anyway
+    __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+    bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), bytes);
+    return ascii == ~std::uint32_t(0) ? block : static_cast<std::size_t>(__builtin_ctz(~ascii));
+}
+#elif defined(__SSE2__)
+inline constexpr std::size_t block = 16;
+
+inline std::size_t narrow_ascii(const char16_t* in, char* out) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(a, b));
+    const __m128i high = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    auto ascii_a = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(a, high), zero)));
+    auto ascii_b = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(b, high), zero)));
+    std::uint32_t ascii = ascii_a | (ascii_b << 16); // two bits per unit
+    return ascii == ~std::uint32_t(0) ? block : static_cast<std::size_t>(__builtin_ctz(~ascii)) / 2;
+}
+
+inline std::size_t narrow_ascii(const char32_t* in, char* out) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 4));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 8));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12));
+    const __m128i high = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+    const __m128i zero = _mm_setzero_si128();
+    auto ascii_of = [&](__m128i v) {
+        return static_cast<std::uint32_t>(_mm_movemask_ps(
+            _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(v, high), zero))));
+    };
+    std::uint32_t ascii = ascii_of(a) | (ascii_of(b) << 4) | (ascii_of(c) << 8) | (ascii_of(d) << 12);
+    // Signed packing only saturates units that are not ASCII anyway
+    __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+    return ascii == 0xFFFF ? block : static_cast<std::size_t>(__builtin_ctz(~ascii));
+}
+#else
+inline constexpr std::size_t block = 16;
+
+template<typename Unit>
+std::size_t narrow_ascii(const Unit* in, char* out) {
+    std::size_t i = 0;
+    for (; i < block && in[i] < 0x80; ++i) {
+        out[i] = static_cast<char>(in[i]);
+    }
+    return i;
+}
+#endif
+
+template<typename Unit>
+transcode_result encode(const Unit* first, std::size_t n, char* out, bool final_chunk) {
+    const Unit* in = first;
+    const Unit* last = first + n;
+    char* const out_first = out;
+    while (static_cast<std::size_t>(last - in) >= block) {
+        std::size_t ascii = narrow_ascii(in, out);
+        in += ascii;
+        out += ascii;
+        if (ascii == block) {
+            continue;
+        }
+        // Encode the run of non-ASCII code points one at a time, then go
+        // back to whole blocks
+        do {
+            if (!encode_one(in, last, out, final_chunk)) {
+                return {static_cast<std::size_t>(in - first), static_cast<std::size_t>(out - out_first)};
+            }
+        } while (in < last && static_cast<char32_t>(*in) >= 0x80);
+    }
+    while (in < last && encode_one(in, last, out, final_chunk)) {
+    }
+    return {static_cast<std::size_t>(in - first), static_cast<std::size_t>(out - out_first)};
+}
+
+} // namespace detail
+
+// Encodes [in, in + n) as UTF-8 into out, which must have room for
+// max_utf8_size<CharT>(n) bytes. Unless final_chunk is set, a high
+// surrogate that ends the input is left unread (read == n - 1) so the
+// caller can pass it again with the rest of its pair.
+template<typename CharT>
+transcode_result to_utf8(const CharT* in, std::size_t n, char* out, bool final_chunk = true) {
+    static_assert(is_utf_char_v<CharT>, "to_utf8 encodes wide or char8_t text");
+    if constexpr (sizeof(CharT) == 1) {
+        std::memcpy(out, in, n);
+        return {n, n};
+    } else if constexpr (sizeof(CharT) == 2) {
+        return detail::encode(reinterpret_cast<const char16_t*>(in), n, out, final_chunk);
+    } else {
+        return detail::encode(reinterpret_cast<const char32_t*>(in), n, out, final_chunk);
+    }
+}
+
+// The wide character type of a text value (a character, a string or
+// anything convertible to a string view), or void
+template<typename U, typename = void>
+struct utf_text_char {
+    using type = void;
+};
+
+template<typename U>
+struct utf_text_char<U, std::enable_if_t<is_utf_char_v<U>>> {
+    using type = U;
+};
+
+template<typename U>
+struct utf_text_char<U, std::enable_if_t<!is_utf_char_v<U>
+    && (std::is_convertible_v<const U&, std::wstring_view> || std::is_convertible_v<const U&, std::u8string_view>
+        || std::is_convertible_v<const U&, std::u16string_view>
+        || std::is_convertible_v<const U&, std::u32string_view>)>> {
+    using type = std::conditional_t<std::is_convertible_v<const U&, std::wstring_view>, wchar_t,
+                 std::conditional_t<std::is_convertible_v<const U&, std::u8string_view>, char8_t,
+                 std::conditional_t<std::is_convertible_v<const U&, std::u16string_view>, char16_t,
+                                    char32_t>>>;
+};
+
+template<typename U>
+using utf_text_char_t = typename utf_text_char<U>::type;
+
+} // namespace joiner_utf
+
+#endif
@@ -1,101 +1,15 @@
+#include "sort.h"
 #include <iostream>
 #include <list>
+#include <deque>
+#include <iomanip>
 #include <vector>
 #include <forward_list>
-#include <algorithm>
-#include <iterator>
 #include <chrono>
-#include <functional>
-#include <type_traits>
-
-// Implementation of sort for forward iterators using merge sort which doesn't require random access
-template<typename ForwardIt, typename Compare = std::less<>>
-void forward_iterator_sort(ForwardIt first, ForwardIt last, Compare comp = Compare{}) {
-    if (first == last || std::next(first) == last) {
-        return;
-    }
-
-    auto count = std::distance(first, last);
-    auto middle = first;
-    std::advance(middle, count / 2);
-
-    forward_iterator_sort(first, middle, comp);
-    forward_iterator_sort(middle, last, comp);
-
-    // need to create a temporary buffer for forward iterators,
-    using value_type = typename std::iterator_traits<ForwardIt>::value_type;
-    std::vector<value_type> buffer(count);
-    
-    auto it1 = first;
-    auto it2 = middle;
-    auto out = buffer.begin();
-    
-    while (it1 != middle && it2 != last) {
-        if (comp(*it2, *it1)) {
-            *out++ = std::move(*it2++);
-        } else {
-            *out++ = std::move(*it1++);
-        }
-    }
-    
-    // Copy remaining elements
-    while (it1 != middle) {
-        *out++ = std::move(*it1++);
-    }
-    while (it2 != last) {
-        *out++ = std::move(*it2++);
-    }
-    
-    // Copy merged sequence back to the original range
-    std::copy(buffer.begin(), buffer.end(), first);
-}
-
-// Optimized version for bidirectional iterators
-// use in-place merge for bidirectional iterators
-template<typename BidirIt, typename Compare = std::less<>>
-void bidirectional_iterator_sort(BidirIt first, BidirIt last, Compare comp = Compare{}) {
-    // Check if we have bidirectional iterators
-    if constexpr (!std::is_base_of_v<std::bidirectional_iterator_tag, 
-                                     typename std::iterator_traits<BidirIt>::iterator_category>) {
-        // if not fall back to forward_iterator_sort for forward iterators
-        forward_iterator_sort(first, last, comp);
-        return;
-    }
-    
-    if (first == last || std::next(first) == last) {
-        return;
-    }
-
-    auto count = std::distance(first, last);
-    auto middle = first;
-    std::advance(middle, count / 2);
-
-    bidirectional_iterator_sort(first, middle, comp);
-    bidirectional_iterator_sort(middle, last, comp);
-
-    // Merge the sorted halves
-    std::inplace_merge(first, middle, last, comp);
-}
-
-// Unified sort function that dispatches to the appropriate implementation
-template<typename Iterator, typename Compare = std::less<>>
-void unified_sort(Iterator first, Iterator last, Compare comp = Compare{}) {
-    // Dispatch based on iterator category
-    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, 
-                                    typename std::iterator_traits<Iterator>::iterator_category>) {
-        // Use standard sort for random access iterators
-        std::sort(first, last, comp);
-    } 
-    else if constexpr (std::is_base_of_v<std::bidirectional_iterator_tag, 
-                                        typename std::iterator_traits<Iterator>::iterator_category>) {
-        // Use bidirectional_iterator_sort for bidirectional iterators
-        bidirectional_iterator_sort(first, last, comp);
-    }
-    else {
-        // Use forward_iterator_sort for forward iterators
-        forward_iterator_sort(first, last, comp);
-    }
-}
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <thread>
 
 // Helper function to time sorting operations
 template<typename Container, typename SortFunc>
@@ -110,6 +24,15 @@ double time_sort(Container& container, SortFunc sort_func, const std::string& na
     return duration.count();
 }
 
+// Milliseconds taken by f, for results printed as a table
+template<typename F>
+double time_quietly(F f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+    return duration.count();
+}
+
 template<typename T>
 void print_container(const T& container, const std::string& label) {
     std::cout << label << ": ";
@@ -131,7 +54,7 @@ int main() {
     std::list<int> list_copy = list_data;
     
     std::cout << "Sorting std::list with " << SIZE << " elements:" << std::endl;
-    time_sort(list_data, [](auto first, auto last) {
+    time_sort(list_data, [&](auto, auto) {
         list_data.sort();
     }, "list::sort()");
     
@@ -148,7 +71,7 @@ int main() {
     std::forward_list<int> fwd_list_copy = fwd_list_data;
     
     std::cout << "\nSorting std::forward_list with " << SIZE << " elements:" << std::endl;
-    time_sort(fwd_list_data, [](auto first, auto last) {
+    time_sort(fwd_list_data, [&](auto, auto) {
         fwd_list_data.sort();
     }, "forward_list::sort()");
     
@@ -156,6 +79,299 @@ int main() {
         unified_sort(first, last);
     }, "unified_sort()");
     
+    // Ranges interface: contiguous numbers take the radix path, lists
+    // report their size instead of being counted
+    std::vector<int> numbers;
+    for (int i = 0; i < SIZE * 100; ++i) {
+        numbers.push_back(rand());
+    }
+    std::vector<int> numbers_copy = numbers;
+    std::list<int> numbers_list(numbers.begin(), numbers.begin() + SIZE * 10);
+    std::list<int> numbers_list_copy = numbers_list;
+
+    std::cout << "\nSorting ranges of " << SIZE * 100 << " and " << SIZE * 10 << " ints:" << std::endl;
+    time_sort(numbers, [](auto first, auto last) {
+        std::sort(first, last);
+    }, "std::sort(vector)");
+
+    time_sort(numbers_copy, [&](auto, auto) {
+        unified_sort(numbers_copy);
+    }, "unified_sort(vector)");
+
+    time_sort(numbers_list, [&](auto, auto) {
+        numbers_list.sort();
+    }, "list::sort()");
+
+    time_sort(numbers_list_copy, [&](auto, auto) {
+        unified_sort(numbers_list_copy);
+    }, "unified_sort(list)");
+
+    std::cout << "Same result: " << std::boolalpha
+              << (numbers == numbers_copy && numbers_list == numbers_list_copy) << std::endl;
+
+    // Random-access engines: unified_sort against std::sort on several
+    // input patterns, in a std::vector and in a std::deque, which
+    // unified_sort sorts block by block. Random numbers are radix sorted;
+    // sorted, reversed and nearly sorted ones go to pdq_sort, whose run
+    // detection handles them in about one pass.
+    std::cout << "\nRandom-access sort of " << SIZE * 100 << " elements (ms):" << std::endl;
+    std::cout << std::setw(22) << "input" << std::setw(12) << "std::sort" << std::setw(12) << "unified"
+              << std::setw(16) << "std::sort deq" << std::setw(16) << "unified deq" << std::endl;
+    auto compare_engines = [&](auto sample, const std::string& type) {
+        using T = decltype(sample);
+        std::vector<std::pair<std::string, std::vector<T>>> inputs(5);
+        inputs[0].first = "random";
+        inputs[1].first = "sorted";
+        inputs[2].first = "reversed";
+        inputs[3].first = "nearly sorted";
+        inputs[4].first = "few unique";
+        for (int i = 0; i < SIZE * 100; ++i) {
+            inputs[0].second.push_back(static_cast<T>(rand()) / 7);
+            inputs[4].second.push_back(static_cast<T>(rand() % 16));
+        }
+        inputs[1].second = inputs[0].second;
+        std::sort(inputs[1].second.begin(), inputs[1].second.end());
+        inputs[2].second.assign(inputs[1].second.rbegin(), inputs[1].second.rend());
+        // One element in a thousand swapped with another
+        inputs[3].second = inputs[1].second;
+        for (int i = 0; i < SIZE / 10; ++i) {
+            std::swap(inputs[3].second[rand() % (SIZE * 100)], inputs[3].second[rand() % (SIZE * 100)]);
+        }
+
+        bool same = true;
+        for (auto& [pattern, input] : inputs) {
+            std::vector<T> expected = input;
+            std::vector<T> actual = input;
+            std::deque<T> deque_expected(input.begin(), input.end());
+            std::deque<T> deque_actual(input.begin(), input.end());
+            std::cout << std::setw(22) << type + " " + pattern << std::fixed << std::setprecision(1)
+                      << std::setw(12) << time_quietly([&] { std::sort(expected.begin(), expected.end()); })
+                      << std::setw(12) << time_quietly([&] { unified_sort(actual.begin(), actual.end()); })
+                      << std::setw(16) << time_quietly([&] {
+                             std::sort(deque_expected.begin(), deque_expected.end());
+                         })
+                      << std::setw(16) << time_quietly([&] { unified_sort(deque_actual); })
+                      << std::defaultfloat << std::setprecision(6) << std::endl;
+            same = same && expected == actual
+                   && std::equal(expected.begin(), expected.end(), deque_expected.begin())
+                   && deque_expected == deque_actual;
+        }
+        std::cout << "Same result: " << std::boolalpha << same << std::endl;
+    };
+    compare_engines(int{}, "int");
+    compare_engines(double{}, "double");
+
+    // Group-by: count how often each of rand() % 1000 occurs, by sorting
+    // and then walking the sorted values, and with sort_aggregate
+    std::vector<int> keys;
+    for (int i = 0; i < SIZE * 100; ++i) {
+        keys.push_back(rand() % 1000);
+    }
+    std::vector<int> keys_copy = keys;
+    std::list<int> key_list(keys.begin(), keys.end());
+    std::list<int> key_list_copy = key_list;
+    std::vector<std::pair<int, std::size_t>> counted;
+    std::vector<std::pair<int, std::size_t>> aggregated;
+
+    std::cout << "\nCounting " << SIZE * 100 << " values of rand() % 1000:" << std::endl;
+    time_sort(keys, [&](auto first, auto last) {
+        unified_sort(first, last);
+        for (auto it = first; it != last; ++it) {
+            if (counted.empty() || counted.back().first != *it) {
+                counted.emplace_back(*it, 0);
+            }
+            ++counted.back().second;
+        }
+    }, "unified_sort() + counting pass");
+
+    time_sort(keys_copy, [&](auto first, auto last) {
+        aggregated = sort_aggregate(first, last, std::identity{},
+                                    [](std::size_t count, int) { return count + 1; });
+    }, "sort_aggregate()");
+
+    std::cout << "Same counts: " << std::boolalpha << (counted == aggregated) << std::endl;
+
+    // The same counts from a std::list: both halves merge sorted in place,
+    // then folded while merging, against list::sort() and a counting pass
+    std::vector<std::pair<int, std::size_t>> list_counted;
+    std::vector<std::pair<int, std::size_t>> list_aggregated;
+    time_sort(key_list, [&](auto, auto) {
+        // list::sort() relinks the nodes, so walk from the new begin()
+        key_list.sort();
+        for (int key : key_list) {
+            if (list_counted.empty() || list_counted.back().first != key) {
+                list_counted.emplace_back(key, 0);
+            }
+            ++list_counted.back().second;
+        }
+    }, "list::sort() + counting pass");
+
+    time_sort(key_list_copy, [&](auto first, auto last) {
+        list_aggregated = sort_aggregate(first, last, std::identity{},
+                                         [](std::size_t count, int) { return count + 1; });
+    }, "sort_aggregate(list)");
+
+    std::cout << "Same counts: " << std::boolalpha
+              << (list_counted == counted && list_aggregated == counted) << std::endl;
+
+    // -0.0 == 0.0, so grouping by value must put them in one group, on
+    // the radix path as on the comparison one
+    std::vector<double> zeros;
+    for (int i = 0; i < SIZE * 10; ++i) {
+        zeros.push_back(i % 3 == 0 ? -0.0 : i % 3 == 1 ? 0.0 : 1.5);
+    }
+    std::vector<double> zeros_copy = zeros;
+    auto count = [](std::size_t n, double) { return n + 1; };
+    auto by_radix = sort_aggregate(zeros.begin(), zeros.end(), std::identity{}, count);
+    auto by_comparison = sort_aggregate(zeros_copy.begin(), zeros_copy.end(),
+                                        [](double d) { return d; }, count);
+    std::cout << "Signed zeros in one group: " << std::boolalpha
+              << (by_radix == by_comparison && by_radix.size() == 2) << std::endl;
+
+    // Top-k: only the first K elements need to end up sorted
+    const int K = 100;
+    std::list<int> topk_list;
+    for (int i = 0; i < SIZE * 10; ++i) {
+        topk_list.push_front(rand());
+    }
+    std::list<int> topk_copy = topk_list;
+
+    std::cout << "\nSmallest " << K << " of std::list with " << SIZE * 10 << " elements:" << std::endl;
+    time_sort(topk_list, [](auto first, auto last) {
+        unified_sort(first, last);
+    }, "unified_sort()");
+
+    time_sort(topk_copy, [K](auto first, auto last) {
+        unified_partial_sort(first, std::next(first, K), last);
+    }, "unified_partial_sort()");
+
+    std::cout << "Same prefix: " << std::boolalpha
+              << std::equal(topk_list.begin(), std::next(topk_list.begin(), K), topk_copy.begin())
+              << std::endl;
+
+    // Stable sort: records sorted by key keep their original order on ties
+    const int RECORDS = SIZE * 100;
+    using record = std::pair<int, int>;
+    auto by_key = [](const record& a, const record& b) { return a.first < b.first; };
+    std::vector<record> records;
+    for (int i = 0; i < RECORDS; ++i) {
+        records.emplace_back(rand() % 1000, i);
+    }
+    std::vector<record> records_std = records;
+    std::vector<record> records_serial = records;
+
+    std::cout << "\nStable sort of " << RECORDS << " records on "
+              << std::thread::hardware_concurrency() << " threads:" << std::endl;
+    time_sort(records_std, [&](auto first, auto last) {
+        std::stable_sort(first, last, by_key);
+    }, "std::stable_sort()");
+
+    time_sort(records_serial, [&](auto first, auto last) {
+        serial_stable_sort(first, last, by_key);
+    }, "serial_stable_sort()");
+
+    time_sort(records, [&](auto first, auto last) {
+        unified_stable_sort(first, last, by_key);
+    }, "unified_stable_sort()");
+
+    std::cout << "Same order: " << std::boolalpha
+              << (records == records_std && records_serial == records_std) << std::endl;
+
+    // K-way merge of many sorted shards
+    const int SHARDS = 256;
+    std::vector<std::vector<int>> vector_shards(SHARDS);
+    std::vector<std::list<int>> list_shards(SHARDS);
+    for (int i = 0; i < SHARDS; ++i) {
+        for (int j = 0; j < SIZE / 2; ++j) {
+            vector_shards[i].push_back(rand());
+        }
+        std::sort(vector_shards[i].begin(), vector_shards[i].end());
+        list_shards[i].assign(vector_shards[i].begin(), vector_shards[i].end());
+    }
+    std::vector<std::list<int>> list_shards_copy = list_shards;
+
+    std::cout << "\nMerging " << SHARDS << " sorted shards of " << SIZE / 2
+              << " elements:" << std::endl;
+    std::vector<int> merged_pairwise;
+    std::vector<int> merged;
+    std::vector<int> merged_parallel(SHARDS * (SIZE / 2));
+    time_sort(merged_pairwise, [&](auto, auto) {
+        // Repeated pairwise merging, as the recursive sorts do
+        std::vector<std::vector<int>> runs = vector_shards;
+        while (runs.size() > 1) {
+            std::vector<std::vector<int>> next;
+            for (std::size_t i = 0; i + 1 < runs.size(); i += 2) {
+                std::vector<int> run(runs[i].size() + runs[i + 1].size());
+                std::merge(runs[i].begin(), runs[i].end(),
+                           runs[i + 1].begin(), runs[i + 1].end(), run.begin());
+                next.push_back(std::move(run));
+            }
+            if (runs.size() % 2 != 0) {
+                next.push_back(std::move(runs.back()));
+            }
+            runs = std::move(next);
+        }
+        merged_pairwise = std::move(runs.front());
+    }, "pairwise std::merge");
+
+    time_sort(merged, [&](auto, auto) {
+        merged.reserve(merged_parallel.size());
+        unified_merge(vector_shards, std::back_inserter(merged));
+    }, "unified_merge()");
+
+    time_sort(merged_parallel, [&](auto first, auto) {
+        unified_parallel_merge(vector_shards, first);
+    }, "unified_parallel_merge()");
+
+    std::cout << "Same result: " << std::boolalpha
+              << (merged == merged_pairwise && merged_parallel == merged_pairwise) << std::endl;
+
+    std::list<int> merged_list;
+    time_sort(list_shards, [&](auto, auto) {
+        for (auto& shard : list_shards) {
+            merged_list.merge(shard);
+        }
+    }, "repeated list::merge()");
+
+    std::list<int> spliced_list;
+    time_sort(list_shards_copy, [&](auto, auto) {
+        unified_splice_merge(list_shards_copy, spliced_list);
+    }, "unified_splice_merge()");
+
+    std::cout << "Same result: " << std::boolalpha << (merged_list == spliced_list) << std::endl;
+
+#if SORT_INSTRUMENTATION
+    // Counts behind the wall-clock numbers, one JSON line per sort; build
+    // with -DSORT_INSTRUMENTATION=1
+    std::forward_list<instrumented<int>> counted_fwd;
+    std::list<instrumented<int>> counted_list;
+    std::vector<instrumented<int>> counted_vector;
+    for (int i = 0; i < SIZE; ++i) {
+        int value = rand() % 1000;
+        counted_fwd.push_front(value);
+        counted_list.push_front(value);
+        counted_vector.push_back(value);
+    }
+    auto counted_fwd_copy = counted_fwd;
+
+    std::cout << "\nInstrumentation report:" << std::endl;
+    sort_report_reset();
+    counted_fwd.sort(instrument_compare(std::less<>{}));
+    write_sort_report(std::cout, "forward_list::sort()");
+
+    sort_report_reset();
+    forward_iterator_sort(counted_fwd_copy.begin(), counted_fwd_copy.end());
+    write_sort_report(std::cout, "forward_iterator_sort()");
+
+    sort_report_reset();
+    unified_sort(counted_list);
+    write_sort_report(std::cout, "unified_sort(list)");
+
+    sort_report_reset();
+    unified_sort(counted_vector);
+    write_sort_report(std::cout, "unified_sort(vector)");
+#endif
+
     std::list<int> small_list = {9, 1, 8, 2, 7, 3, 6, 4, 5};
     std::forward_list<int> small_fwd_list = {9, 1, 8, 2, 7, 3, 6, 4, 5};
     
@@ -168,6 +384,32 @@ int main() {
     print_container(small_fwd_list, "Before sort (forward_list)");
     unified_sort(small_fwd_list.begin(), small_fwd_list.end());
     print_container(small_fwd_list, "After sort (forward_list)");
+
+    std::forward_list<int> partial_fwd_list = {9, 1, 8, 2, 7, 3, 6, 4, 5};
+    unified_partial_sort(partial_fwd_list.begin(), std::next(partial_fwd_list.begin(), 3),
+                         partial_fwd_list.end());
+    print_container(partial_fwd_list, "After partial_sort of 3 (forward_list)");
+
+    std::list<int> nth_list = {9, 1, 8, 2, 7, 3, 6, 4, 5};
+    auto median = std::next(nth_list.begin(), 4);
+    unified_nth_element(nth_list.begin(), median, nth_list.end());
+    print_container(nth_list, "After nth_element at 4 (list)");
+    std::cout << "Median: " << *median << std::endl;
+
+    std::list<std::pair<std::string, int>> people = {{"carol", 35}, {"alice", 30}, {"bob", 25}};
+    unified_sort(people, std::ranges::less{}, &std::pair<std::string, int>::second);
+    std::cout << "By age (list, projection):";
+    for (const auto& [name, age] : people) {
+        std::cout << " " << name << "=" << age;
+    }
+    std::cout << std::endl;
+
+    std::list<int> odd = {1, 3, 5, 7};
+    std::vector<int> even = {2, 4, 6, 8};
+    std::forward_list<int> tens = {0, 10};
+    std::vector<int> merged_small;
+    unified_merge(std::tie(odd, even, tens), std::back_inserter(merged_small));
+    print_container(merged_small, "unified_merge(list, vector, forward_list)");
     
     return 0;
 }
\ No newline at end of file
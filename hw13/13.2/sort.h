@@ -0,0 +1,1459 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <future>
+#include <list>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include "sort_instrumentation.h"
+
+namespace sort_detail {
+
+// Below this size stable_merge_sort switches to insertion sort
+inline constexpr std::ptrdiff_t insertion_sort_size = 16;
+
+// Below this size radix_sort hands over to std::sort
+inline constexpr std::size_t radix_sort_size = 256;
+
+// Input with fewer than n / presorted_ratio descents (or ascents) is left
+// to pdq_sort, which finishes such runs in about one pass
+inline constexpr std::size_t presorted_ratio = 256;
+
+template<typename BidirIt, typename Compare>
+void insertion_sort(BidirIt first, BidirIt last, Compare& comp) {
+    if (first == last) {
+        return;
+    }
+    for (auto it = std::next(first); it != last; ++it) {
+        auto value = std::move(*it);
+        auto hole = it;
+        for (auto prev = std::prev(hole); comp(value, *prev); --prev) {
+            *hole = std::move(*prev);
+            hole = prev;
+            if (prev == first) {
+                break;
+            }
+        }
+        *hole = std::move(value);
+    }
+}
+
+// Stable merge sort of the n elements starting at first; returns their
+// end. Each half's recursion hands back where the next half starts, so
+// the element count is computed once by the caller and no level walks the
+// list to find its midpoint. scratch must have room for n / 2 elements;
+// it holds the left half during each merge, so no level allocates and
+// forward iterators are enough.
+template<typename ForwardIt, typename ScratchIt, typename Compare>
+ForwardIt stable_merge_sort(ForwardIt first, std::ptrdiff_t n, ScratchIt scratch, Compare& comp) {
+    SORT_DEPTH_SCOPE();
+    constexpr bool bidirectional =
+        std::is_base_of_v<std::bidirectional_iterator_tag,
+                          typename std::iterator_traits<ForwardIt>::iterator_category>;
+    if constexpr (bidirectional) {
+        if (n <= insertion_sort_size) {
+            auto last = next_counted(first, n);
+            insertion_sort(first, last, comp);
+            return last;
+        }
+    }
+    if (n < 2) {
+        return n == 0 ? first : next_counted(first);
+    }
+
+    std::ptrdiff_t half = n / 2;
+    auto middle = stable_merge_sort(first, half, scratch, comp);
+    auto last = stable_merge_sort(middle, n - half, scratch, comp);
+
+    // Already in order: nothing to merge
+    if constexpr (bidirectional) {
+        if (!comp(*middle, *std::prev(middle))) {
+            return last;
+        }
+    }
+
+    // The output never overtakes the right half, so merging back into
+    // place only needs the left half out of the way. Ties take the left
+    // element, which keeps the sort stable.
+    auto left = scratch;
+    auto left_end = std::move(first, middle, scratch);
+    auto right = middle;
+    auto out = first;
+    while (left != left_end && right != last) {
+        if (comp(*right, *left)) {
+            *out++ = std::move(*right++);
+        } else {
+            *out++ = std::move(*left++);
+        }
+    }
+    std::move(left, left_end, out);
+    return last;
+}
+
+// Sorts the n elements starting at first with one scratch allocation
+template<typename ForwardIt, typename Compare>
+ForwardIt merge_sort_n(ForwardIt first, std::ptrdiff_t n, Compare& comp) {
+    using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+    if (n < 2) {
+        return next_counted(first, n);
+    }
+    std::vector<value_type> scratch(n / 2);
+    count_allocation<value_type>(scratch.size());
+    return stable_merge_sort(first, n, scratch.begin(), comp);
+}
+
+// Comparators that mean "ascending by operator<"
+template<typename Compare, typename T>
+inline constexpr bool is_ascending_v =
+    std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<T>>
+    || std::is_same_v<Compare, std::ranges::less>;
+
+// Element types that radix_sort orders exactly as operator< does
+template<typename T>
+inline constexpr bool is_radix_key_v =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    || (std::is_same_v<T, float> && std::numeric_limits<float>::is_iec559)
+    || (std::is_same_v<T, double> && std::numeric_limits<double>::is_iec559);
+
+// Maps a value to an unsigned key with the same ordering
+template<typename T>
+auto radix_key(T value) {
+    using key_type = std::make_unsigned_t<
+        std::conditional_t<sizeof(T) == 8, std::int64_t,
+        std::conditional_t<sizeof(T) == 4, std::int32_t,
+        std::conditional_t<sizeof(T) == 2, std::int16_t, std::int8_t>>>>;
+    constexpr key_type sign_bit = key_type(1) << (8 * sizeof(T) - 1);
+    if constexpr (std::is_floating_point_v<T>) {
+        // -0.0 == 0.0, so both get the key of 0.0; otherwise they would
+        // land in different buckets and, in radix_aggregate, groups
+        value = value == T(0) ? T(0) : value;
+    }
+    auto bits = std::bit_cast<key_type>(value);
+    if constexpr (std::is_floating_point_v<T>) {
+        // Negative numbers have every bit flipped, so larger magnitudes
+        // sort first; positive ones only the sign bit
+        auto mask = static_cast<key_type>(key_type(0) - (bits >> (8 * sizeof(T) - 1))) | sign_bit;
+        return static_cast<key_type>(bits ^ mask);
+    } else if constexpr (std::is_signed_v<T>) {
+        return static_cast<key_type>(bits ^ sign_bit);
+    } else {
+        return bits;
+    }
+}
+
+// Byte `pass` of value's radix key
+template<typename T>
+std::size_t radix_byte(T value, std::size_t pass) {
+    return (radix_key(value) >> (8 * pass)) & 0xff;
+}
+
+// The passes of an LSD radix sort of data that move anything, lowest
+// byte first, with the histogram of each pass. All histograms are
+// gathered in one read; a pass whose byte is the same for every element
+// is left out.
+template<typename T>
+auto radix_plan(const T* data, std::size_t n) {
+    constexpr std::size_t passes = sizeof(T);
+    std::vector<std::array<std::size_t, 256>> counts(passes);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto key = radix_key(data[i]);
+        for (std::size_t pass = 0; pass < passes; ++pass) {
+            ++counts[pass][(key >> (8 * pass)) & 0xff];
+        }
+    }
+    std::vector<std::pair<std::size_t, std::array<std::size_t, 256>>> moving;
+    for (std::size_t pass = 0; pass < passes; ++pass) {
+        if (counts[pass][radix_byte(data[0], pass)] != n) {
+            moving.emplace_back(pass, counts[pass]);
+        }
+    }
+    return moving;
+}
+
+// One radix pass: stably scatters from into to by byte `pass`
+template<typename T>
+void radix_scatter(const T* from, T* to, std::size_t n, std::size_t pass,
+                   std::array<std::size_t, 256>& count) {
+    std::size_t offset = 0;
+    for (std::size_t& c : count) {
+        offset += std::exchange(c, offset);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        to[count[radix_byte(from[i], pass)]++] = from[i];
+    }
+}
+
+// LSD radix sort of a contiguous array of numbers, one byte per pass.
+// Passes whose byte is the same for every element are skipped, and
+// elements move as raw bytes between data and one scratch array.
+template<typename T>
+void radix_sort(T* data, std::size_t n) {
+    if (n < radix_sort_size) {
+        std::sort(data, data + n);
+        return;
+    }
+    auto plan = radix_plan(data, n);
+    if (plan.empty()) {
+        return;
+    }
+    std::unique_ptr<T[]> scratch(new T[n]);
+    count_allocation<T>(n);
+    T* from = data;
+    T* to = scratch.get();
+    for (auto& [pass, count] : plan) {
+        radix_scatter(from, to, n, pass, count);
+        std::swap(from, to);
+    }
+    if (from != data) {
+        std::memcpy(data, from, n * sizeof(T));
+    }
+}
+
+// Group-by on numbers: every radix pass but the last is run as usual. The
+// last one would put the elements in order, but within each of its 256
+// buckets they already arrive in order, so instead of being scattered
+// they are folded into that bucket's groups right away. The buckets'
+// groups, concatenated, are the result. Leaves data in unspecified order.
+template<typename T, typename Reducer, typename Aggregate>
+std::vector<std::pair<T, Aggregate>> radix_aggregate(T* data, std::size_t n, Reducer& reducer,
+                                                     const Aggregate& init) {
+    auto plan = radix_plan(data, n);
+    std::unique_ptr<T[]> scratch;
+    T* from = data;
+    if (plan.size() > 1) {
+        scratch.reset(new T[n]);
+        count_allocation<T>(n);
+        T* to = scratch.get();
+        for (std::size_t i = 0; i + 1 < plan.size(); ++i) {
+            radix_scatter(from, to, n, plan[i].first, plan[i].second);
+            std::swap(from, to);
+        }
+    }
+
+    std::size_t last_pass = plan.empty() ? 0 : plan.back().first;
+    std::array<std::vector<std::pair<T, Aggregate>>, 256> buckets;
+    for (std::size_t i = 0; i < n; ++i) {
+        T value = from[i];
+        auto& groups = buckets[radix_byte(value, last_pass)];
+        if (!groups.empty() && !(groups.back().first < value)) {
+            groups.back().second = std::invoke(reducer, std::move(groups.back().second), value);
+        } else {
+            groups.emplace_back(value, std::invoke(reducer, init, value));
+        }
+    }
+    std::vector<std::pair<T, Aggregate>> result;
+    for (auto& groups : buckets) {
+        std::move(groups.begin(), groups.end(), std::back_inserter(result));
+    }
+    return result;
+}
+
+
+// pdq_sort tuning, as in Orson Peters' pattern-defeating quicksort
+inline constexpr std::ptrdiff_t pdq_insertion_size = 24;     // insertion sort below this
+inline constexpr std::ptrdiff_t pdq_ninther_size = 128;      // median of nine pivots above this
+inline constexpr std::ptrdiff_t pdq_partial_insertion_limit = 8;
+inline constexpr std::ptrdiff_t pdq_block_size = 64;         // offsets per partition block
+
+// Comparators for which branchless block partitioning pays off: cheap,
+// and comparing with them does not branch by itself
+template<typename Compare, typename T>
+inline constexpr bool is_branchless_v =
+    std::is_arithmetic_v<T>
+    && (is_ascending_v<Compare, T> || std::is_same_v<Compare, std::greater<>>
+        || std::is_same_v<Compare, std::greater<T>> || std::is_same_v<Compare, std::ranges::greater>);
+
+#if SORT_INSTRUMENTATION
+// A counted comparator takes the same path as the one it wraps
+template<typename Compare, typename T>
+inline constexpr bool is_ascending_v<counted_compare<Compare>, T> = is_ascending_v<Compare, T>;
+
+template<typename Compare, typename T>
+inline constexpr bool is_branchless_v<counted_compare<Compare>, T> = is_branchless_v<Compare, T>;
+#endif
+
+// Insertion sort for a range that has an element no greater than any of
+// its own just before first, so the inner loop needs no bounds check
+template<typename RandomIt, typename Compare>
+void unguarded_insertion_sort(RandomIt first, RandomIt last, Compare& comp) {
+    for (auto it = first + 1; it < last; ++it) {
+        if (comp(*it, *(it - 1))) {
+            auto value = std::move(*it);
+            auto hole = it;
+            do {
+                *hole = std::move(*(hole - 1));
+                --hole;
+            } while (comp(value, *(hole - 1)));
+            *hole = std::move(value);
+        }
+    }
+}
+
+// Insertion sort that gives up once it has moved more than
+// pdq_partial_insertion_limit elements; returns whether the range is sorted
+template<typename RandomIt, typename Compare>
+bool partial_insertion_sort(RandomIt first, RandomIt last, Compare& comp) {
+    std::ptrdiff_t moved = 0;
+    for (auto it = first + 1; it < last; ++it) {
+        if (comp(*it, *(it - 1))) {
+            auto value = std::move(*it);
+            auto hole = it;
+            do {
+                *hole = std::move(*(hole - 1));
+                --hole;
+            } while (hole != first && comp(value, *(hole - 1)));
+            *hole = std::move(value);
+            moved += it - hole;
+            if (moved > pdq_partial_insertion_limit) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<typename RandomIt, typename Compare>
+void sort2(RandomIt a, RandomIt b, Compare& comp) {
+    if (comp(*b, *a)) {
+        std::iter_swap(a, b);
+    }
+}
+
+template<typename RandomIt, typename Compare>
+void sort3(RandomIt a, RandomIt b, RandomIt c, Compare& comp) {
+    sort2(a, b, comp);
+    sort2(b, c, comp);
+    sort2(a, b, comp);
+}
+
+// Moves the elements at the first num left offsets into the slots at the
+// first num right offsets and back. When both blocks have the same number
+// of misplaced elements they are swapped pairwise; otherwise a cyclic
+// rotation does it with one move per element.
+template<typename RandomIt>
+void swap_offsets(RandomIt left_base, RandomIt right_base, const unsigned char* left,
+                  const unsigned char* right, std::size_t num, bool use_swaps) {
+    if (use_swaps) {
+        for (std::size_t i = 0; i < num; ++i) {
+            std::iter_swap(left_base + left[i], right_base - right[i]);
+        }
+    } else if (num > 0) {
+        RandomIt l = left_base + left[0];
+        RandomIt r = right_base - right[0];
+        auto value = std::move(*l);
+        *l = std::move(*r);
+        for (std::size_t i = 1; i < num; ++i) {
+            l = left_base + left[i];
+            *r = std::move(*l);
+            r = right_base - right[i];
+            *l = std::move(*r);
+        }
+        *r = std::move(value);
+    }
+}
+
+// Partitions [first, last) around the pivot *first: elements less than
+// it go left, the rest right. Returns the pivot's final position and
+// whether no element had to move. When Branchless is set the unknown
+// middle is classified a block at a time (BlockQuicksort, Edelkamp and
+// Weiss): each element's comparison result is stored as an offset with
+// no conditional jump, and only then are misplaced elements swapped, so
+// random input no longer costs a branch misprediction per element.
+template<bool Branchless, typename RandomIt, typename Compare>
+std::pair<RandomIt, bool> partition_right(RandomIt first, RandomIt last, Compare& comp) {
+    auto pivot = std::move(*first);
+    RandomIt left = first;
+    RandomIt right = last;
+
+    // The median-of-three guarantees an element >= pivot on the right, so
+    // the first scan needs no bound; the second does only if nothing was
+    // found on the left
+    while (comp(*++left, pivot)) {
+    }
+    if (left - 1 == first) {
+        while (left < right && !comp(*--right, pivot)) {
+        }
+    } else {
+        while (!comp(*--right, pivot)) {
+        }
+    }
+    bool already_partitioned = left >= right;
+
+    if constexpr (Branchless) {
+        if (!already_partitioned) {
+            std::iter_swap(left, right);
+            ++left;
+
+            alignas(64) unsigned char offsets_l[pdq_block_size];
+            alignas(64) unsigned char offsets_r[pdq_block_size];
+            std::size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+            // Offsets of misplaced elements within the next unknown block
+            // on either side
+            auto fill_left = [&](std::ptrdiff_t size) {
+                start_l = 0;
+                RandomIt it = left;
+                for (std::ptrdiff_t i = 0; i < size; ++i, ++it) {
+                    offsets_l[num_l] = static_cast<unsigned char>(i);
+                    num_l += !comp(*it, pivot);
+                }
+            };
+            auto fill_right = [&](std::ptrdiff_t size) {
+                start_r = 0;
+                RandomIt it = right;
+                for (std::ptrdiff_t i = 0; i < size;) {
+                    offsets_r[num_r] = static_cast<unsigned char>(++i);
+                    num_r += comp(*--it, pivot);
+                }
+            };
+            auto swap_blocks = [&] {
+                std::size_t num = std::min(num_l, num_r);
+                swap_offsets(left, right, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+                num_l -= num;
+                num_r -= num;
+                start_l += num;
+                start_r += num;
+            };
+
+            while (right - left > 2 * pdq_block_size) {
+                if (num_l == 0) {
+                    fill_left(pdq_block_size);
+                }
+                if (num_r == 0) {
+                    fill_right(pdq_block_size);
+                }
+                swap_blocks();
+                if (num_l == 0) {
+                    left += pdq_block_size;
+                }
+                if (num_r == 0) {
+                    right -= pdq_block_size;
+                }
+            }
+
+            // Fewer than three blocks left: split what is unknown between
+            // the sides, one of which may still hold a pending block
+            std::ptrdiff_t size_l = 0, size_r = 0;
+            std::ptrdiff_t unknown = (right - left) - ((num_l || num_r) ? pdq_block_size : 0);
+            if (num_r) {
+                size_l = unknown;
+                size_r = pdq_block_size;
+            } else if (num_l) {
+                size_l = pdq_block_size;
+                size_r = unknown;
+            } else {
+                size_l = unknown / 2;
+                size_r = unknown - size_l;
+            }
+            if (unknown && !num_l) {
+                fill_left(size_l);
+            }
+            if (unknown && !num_r) {
+                fill_right(size_r);
+            }
+            swap_blocks();
+            if (num_l == 0) {
+                left += size_l;
+            }
+            if (num_r == 0) {
+                right -= size_r;
+            }
+
+            // One side may still hold misplaced elements; move them across
+            // to the boundary
+            if (num_l) {
+                while (num_l--) {
+                    std::iter_swap(left + offsets_l[start_l + num_l], --right);
+                }
+                left = right;
+            }
+            if (num_r) {
+                while (num_r--) {
+                    std::iter_swap(right - offsets_r[start_r + num_r], left);
+                    ++left;
+                }
+                right = left;
+            }
+        }
+    } else {
+        while (left < right) {
+            std::iter_swap(left, right);
+            while (comp(*++left, pivot)) {
+            }
+            while (!comp(*--right, pivot)) {
+            }
+        }
+    }
+
+    RandomIt pivot_pos = left - 1;
+    *first = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return {pivot_pos, already_partitioned};
+}
+
+// Partitions [first, last) into elements equal to the pivot *first and
+// elements greater than it. Used when the pivot equals the element just
+// before the range, which no element can be less than, so the equal run
+// is finished in one linear pass and never partitioned again.
+template<typename RandomIt, typename Compare>
+RandomIt partition_left(RandomIt first, RandomIt last, Compare& comp) {
+    auto pivot = std::move(*first);
+    RandomIt left = first;
+    RandomIt right = last;
+    while (comp(pivot, *--right)) {
+    }
+    if (right + 1 == last) {
+        while (left < right && !comp(pivot, *++left)) {
+        }
+    } else {
+        while (!comp(pivot, *++left)) {
+        }
+    }
+    while (left < right) {
+        std::iter_swap(left, right);
+        while (comp(pivot, *--right)) {
+        }
+        while (!comp(pivot, *++left)) {
+        }
+    }
+    *first = std::move(*right);
+    *right = std::move(pivot);
+    return right;
+}
+
+// Pattern-defeating quicksort loop. Sorted and reverse-sorted input is
+// finished by a bounded insertion sort when a partition moves nothing;
+// runs of equal keys are split off by partition_left; each highly
+// unbalanced partition shuffles a few elements to break the pattern and
+// spends one of bad_allowed, and once none are left heapsort takes over,
+// bounding the whole sort at O(n log n). leftmost says whether an element
+// before first exists to act as a sentinel.
+template<bool Branchless, typename RandomIt, typename Compare>
+void pdq_loop(RandomIt first, RandomIt last, Compare& comp, int bad_allowed, bool leftmost) {
+    SORT_DEPTH_SCOPE();
+    for (;;) {
+        std::ptrdiff_t size = last - first;
+        if (size < pdq_insertion_size) {
+            if (leftmost) {
+                insertion_sort(first, last, comp);
+            } else {
+                unguarded_insertion_sort(first, last, comp);
+            }
+            return;
+        }
+
+        // Pivot goes to *first: median of three, or pseudomedian of nine
+        std::ptrdiff_t half = size / 2;
+        if (size > pdq_ninther_size) {
+            sort3(first, first + half, last - 1, comp);
+            sort3(first + 1, first + (half - 1), last - 2, comp);
+            sort3(first + 2, first + (half + 1), last - 3, comp);
+            sort3(first + (half - 1), first + half, first + (half + 1), comp);
+            std::iter_swap(first, first + half);
+        } else {
+            sort3(first + half, first, last - 1, comp);
+        }
+
+        if (!leftmost && !comp(*(first - 1), *first)) {
+            first = partition_left(first, last, comp) + 1;
+            continue;
+        }
+
+        auto [pivot_pos, already_partitioned] = partition_right<Branchless>(first, last, comp);
+        std::ptrdiff_t size_l = pivot_pos - first;
+        std::ptrdiff_t size_r = last - (pivot_pos + 1);
+
+        if (size_l < size / 8 || size_r < size / 8) {
+            if (--bad_allowed == 0) {
+                std::make_heap(first, last, comp);
+                std::sort_heap(first, last, comp);
+                return;
+            }
+            if (size_l >= pdq_insertion_size) {
+                std::iter_swap(first, first + size_l / 4);
+                std::iter_swap(pivot_pos - 1, pivot_pos - size_l / 4);
+                if (size_l > pdq_ninther_size) {
+                    std::iter_swap(first + 1, first + (size_l / 4 + 1));
+                    std::iter_swap(first + 2, first + (size_l / 4 + 2));
+                    std::iter_swap(pivot_pos - 2, pivot_pos - (size_l / 4 + 1));
+                    std::iter_swap(pivot_pos - 3, pivot_pos - (size_l / 4 + 2));
+                }
+            }
+            if (size_r >= pdq_insertion_size) {
+                std::iter_swap(pivot_pos + 1, pivot_pos + (1 + size_r / 4));
+                std::iter_swap(last - 1, last - size_r / 4);
+                if (size_r > pdq_ninther_size) {
+                    std::iter_swap(pivot_pos + 2, pivot_pos + (2 + size_r / 4));
+                    std::iter_swap(pivot_pos + 3, pivot_pos + (3 + size_r / 4));
+                    std::iter_swap(last - 2, last - (1 + size_r / 4));
+                    std::iter_swap(last - 3, last - (2 + size_r / 4));
+                }
+            }
+        } else if (already_partitioned && partial_insertion_sort(first, pivot_pos, comp)
+                   && partial_insertion_sort(pivot_pos + 1, last, comp)) {
+            return;
+        }
+
+        // Recurse into the left part, loop on the right
+        pdq_loop<Branchless>(first, pivot_pos, comp, bad_allowed, leftmost);
+        first = pivot_pos + 1;
+        leftmost = false;
+    }
+}
+
+} // namespace sort_detail
+
+// Implementation of sort for forward iterators using merge sort which doesn't require random access
+template<typename ForwardIt, typename Compare = std::less<>>
+void forward_iterator_sort(ForwardIt first, ForwardIt last, Compare comp = Compare{}) {
+    // Counted once here; the recursion passes counts down
+    auto counted = instrument_compare(comp);
+    sort_detail::merge_sort_n(first, sort_detail::distance_counted(first, last), counted);
+}
+
+// Optimized version for bidirectional iterators
+// merges in place and sorts short runs by insertion
+template<typename BidirIt, typename Compare = std::less<>>
+void bidirectional_iterator_sort(BidirIt first, BidirIt last, Compare comp = Compare{}) {
+    // The merge sort only uses --it on bidirectional iterators, so forward
+    // iterators take the same path
+    auto counted = instrument_compare(comp);
+    sort_detail::merge_sort_n(first, sort_detail::distance_counted(first, last), counted);
+}
+
+// Pattern-defeating quicksort for random-access iterators: O(n log n) in
+// the worst case, linear on sorted, reverse-sorted and all-equal input.
+// Numbers compared with std::less or std::greater are partitioned with
+// branchless block partitioning. Not stable.
+template<typename RandomIt, typename Compare = std::less<>>
+void pdq_sort(RandomIt first, RandomIt last, Compare comp = Compare{}) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    auto n = last - first;
+    if (n < 2) {
+        return;
+    }
+    auto counted = instrument_compare(comp);
+    sort_detail::pdq_loop<sort_detail::is_branchless_v<Compare, value_type>>(
+        first, last, counted, std::bit_width(static_cast<std::size_t>(n)), true);
+}
+
+namespace sort_detail {
+
+// Whether data is nearly one ascending or one descending run. Stops as
+// soon as both directions have too many steps, so random input costs a
+// scan of about n / (presorted_ratio / 4) elements.
+template<typename T>
+bool nearly_presorted(const T* data, std::size_t n) {
+    std::size_t limit = n / presorted_ratio;
+    std::size_t descents = 0, ascents = 0;
+    for (std::size_t i = 1; i < n; ++i) {
+        descents += data[i] < data[i - 1];
+        ascents += data[i - 1] < data[i];
+        if (descents > limit && ascents > limit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sorts a contiguous array with the fastest kernel that applies: radix
+// sort for numbers in ascending order, except when they are nearly in
+// order already, where pdq_sort's run detection wins and needs no scratch
+template<typename T, typename Compare>
+void sort_contiguous(T* first, T* last, Compare& comp) {
+    if constexpr (is_radix_key_v<T> && is_ascending_v<Compare, T>) {
+        auto n = static_cast<std::size_t>(last - first);
+        if (!nearly_presorted(first, n)) {
+            radix_sort(first, n);
+            return;
+        }
+    }
+    pdq_sort(first, last, comp);
+}
+
+// Iterators whose elements live in a chain of separately allocated
+// contiguous blocks, where every access goes through a block map
+template<typename Iterator>
+inline constexpr bool is_segmented_v =
+    std::is_same_v<Iterator, typename std::deque<typename std::iterator_traits<Iterator>::value_type>::iterator>;
+
+// The contiguous blocks that make up [first, last), found by checking
+// where consecutive elements stop being adjacent in memory
+template<typename Iterator>
+auto contiguous_segments(Iterator first, Iterator last) {
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+    std::vector<std::span<value_type>> segments;
+    while (first != last) {
+        value_type* begin = std::addressof(*first);
+        value_type* end = begin + 1;
+        for (++first; first != last && std::addressof(*first) == end; ++first) {
+            ++end;
+        }
+        segments.emplace_back(begin, end);
+    }
+    return segments;
+}
+
+// Sorts a segmented range by gathering its blocks into one array, sorting
+// that with a contiguous kernel and scattering the result back block by
+// block, so only whole-block moves pay for the block map
+template<typename Iterator, typename Compare>
+void segmented_sort(Iterator first, Iterator last, Compare& comp) {
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+    auto segments = contiguous_segments(first, last);
+    if (segments.size() <= 1) {
+        if (!segments.empty()) {
+            sort_contiguous(segments[0].data(), segments[0].data() + segments[0].size(), comp);
+        }
+        return;
+    }
+    std::vector<value_type> buffer;
+    buffer.reserve(static_cast<std::size_t>(last - first));
+    count_allocation<value_type>(buffer.capacity());
+    for (auto segment : segments) {
+        buffer.insert(buffer.end(), std::make_move_iterator(segment.begin()),
+                      std::make_move_iterator(segment.end()));
+    }
+    sort_contiguous(buffer.data(), buffer.data() + buffer.size(), comp);
+    auto sorted = buffer.begin();
+    for (auto segment : segments) {
+        auto next = sorted + static_cast<std::ptrdiff_t>(segment.size());
+        std::move(sorted, next, segment.begin());
+        sorted = next;
+    }
+}
+
+} // namespace sort_detail
+
+// Unified sort function that dispatches to the appropriate implementation.
+// Stable for forward and bidirectional iterators only; use
+// unified_stable_sort when equal elements must keep their order.
+template<typename Iterator, typename Compare = std::less<>>
+    requires (!std::ranges::range<Iterator>) // leave ranges to the overload below
+void unified_sort(Iterator first, Iterator last, Compare user_comp = Compare{}) {
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+    auto comp = instrument_compare(user_comp);
+    // Dispatch based on iterator category
+    if constexpr (std::contiguous_iterator<Iterator> && sort_detail::is_radix_key_v<value_type>
+                  && sort_detail::is_ascending_v<Compare, value_type>) {
+        // Plain numbers in contiguous memory: radix sort the raw array,
+        // unless it is nearly sorted already
+        auto data = std::to_address(first);
+        sort_detail::sort_contiguous(data, data + (last - first), comp);
+    }
+    else if constexpr (sort_detail::is_segmented_v<Iterator>) {
+        // std::deque: sort block by block instead of through the block map
+        sort_detail::segmented_sort(first, last, comp);
+    }
+    else if constexpr (std::is_base_of_v<std::random_access_iterator_tag, 
+                                         typename std::iterator_traits<Iterator>::iterator_category>) {
+        pdq_sort(first, last, comp);
+    } 
+    else if constexpr (std::is_base_of_v<std::bidirectional_iterator_tag, 
+                                        typename std::iterator_traits<Iterator>::iterator_category>) {
+        // Use bidirectional_iterator_sort for bidirectional iterators
+        bidirectional_iterator_sort(first, last, comp);
+    }
+    else {
+        // Use forward_iterator_sort for forward iterators
+        forward_iterator_sort(first, last, comp);
+    }
+}
+
+// Ranges interface: unified_sort(range, comp, proj) sorts by the projected
+// values. Contiguous ranges of numbers sorted ascending by their own value
+// are radix sorted unless nearly in order already, deques are sorted block by block and other
+// random-access ranges use pdq_sort. For list-like ranges the element
+// count comes from size() when the range is sized (std::list) and is
+// counted once otherwise (std::forward_list).
+// Returns the end of the range.
+template<std::ranges::forward_range Range, typename Compare = std::ranges::less,
+         typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<Range>, Compare, Proj>
+std::ranges::borrowed_iterator_t<Range> unified_sort(Range&& r, Compare comp = Compare{},
+                                                     Proj proj = Proj{}) {
+    using value_type = std::ranges::range_value_t<Range>;
+    auto first = std::ranges::begin(r);
+    if constexpr (std::ranges::contiguous_range<Range> && sort_detail::is_radix_key_v<value_type>
+                  && sort_detail::is_ascending_v<Compare, value_type>
+                  && std::is_same_v<Proj, std::identity>) {
+        auto n = std::ranges::size(r);
+        sort_detail::sort_contiguous(std::ranges::data(r), std::ranges::data(r) + n, comp);
+        return first + static_cast<std::ranges::range_difference_t<Range>>(n);
+    } else if constexpr (std::ranges::random_access_range<Range>) {
+        auto last = std::ranges::next(first, std::ranges::end(r));
+        if constexpr (std::is_same_v<Proj, std::identity>) {
+            unified_sort(first, last, comp);
+        } else {
+            unified_sort(first, last, [&](const auto& a, const auto& b) {
+                return std::invoke(comp, std::invoke(proj, a), std::invoke(proj, b));
+            });
+        }
+        return last;
+    } else {
+        std::ptrdiff_t n;
+        if constexpr (std::ranges::sized_range<Range>) {
+            n = static_cast<std::ptrdiff_t>(std::ranges::size(r));
+        } else {
+            n = sort_detail::distance_counted(first, std::ranges::next(first, std::ranges::end(r)));
+        }
+        auto projected = instrument_compare([&](const auto& a, const auto& b) {
+            return std::invoke(comp, std::invoke(proj, a), std::invoke(proj, b));
+        });
+        return sort_detail::merge_sort_n(first, n, projected);
+    }
+}
+
+namespace sort_detail {
+
+// The aggregate type a reducer folds into: the first parameter of its
+// call operator, as in [](std::size_t count, int) { return count + 1; }
+template<typename Signature>
+struct reducer_signature;
+
+template<typename R, typename A, typename... Rest>
+struct reducer_signature<R (*)(A, Rest...)> {
+    using aggregate_type = std::decay_t<A>;
+};
+
+template<typename R, typename C, typename A, typename... Rest>
+struct reducer_signature<R (C::*)(A, Rest...)> : reducer_signature<R (*)(A, Rest...)> {
+};
+
+template<typename R, typename C, typename A, typename... Rest>
+struct reducer_signature<R (C::*)(A, Rest...) const> : reducer_signature<R (*)(A, Rest...)> {
+};
+
+// A lambda whose element parameter is auto has a call operator template;
+// it is looked at as instantiated for the element type T
+template<typename F, typename T>
+constexpr auto call_operator() {
+    if constexpr (std::is_pointer_v<F>) {
+        return F{};
+    } else if constexpr (requires { &F::operator(); }) {
+        return &F::operator();
+    } else {
+        return &F::template operator()<T>;
+    }
+}
+
+template<typename F, typename T>
+using aggregate_type_t = typename reducer_signature<decltype(call_operator<F, T>())>::aggregate_type;
+
+// Below this size sort_aggregate sorts in one piece
+inline constexpr std::ptrdiff_t aggregate_merge_size = 1024;
+
+// Sorts [first, last) by key, through the radix path when the elements are
+// their own numeric keys
+template<typename RandomIt, typename Key>
+void sort_by_key(RandomIt first, RandomIt last, Key& key) {
+    if constexpr (std::is_same_v<Key, std::identity>) {
+        unified_sort(first, last);
+    } else {
+        unified_sort(first, last, [&](const auto& a, const auto& b) {
+            return std::invoke(key, a) < std::invoke(key, b);
+        });
+    }
+}
+
+} // namespace sort_detail
+
+// Sort-based group-by: returns one (key, aggregate) pair per distinct key,
+// in ascending key order, where each aggregate is init folded with
+// reducer(aggregate, element) over the elements with that key. Instead of
+// sorting everything and then walking the sorted range again, the last
+// step of the sort folds equal keys as it goes, so the sorted sequence is
+// never written out: that step reads each element once and writes only
+// the compact result. For contiguous numbers grouped by value the last
+// step is the final radix pass; otherwise the two halves are sorted and
+// their merge does the folding. Lists and other forward ranges have their
+// halves merge sorted in place, so they too skip the final merge and the
+// walk over the sorted list. Leaves [first, last) in unspecified order.
+// Keys need operator<.
+//
+//     // How often each value occurs
+//     auto counts = sort_aggregate(v.begin(), v.end(), std::identity{},
+//                                  [](std::size_t n, int) { return n + 1; });
+template<typename ForwardIt, typename Key, typename Reducer, typename Aggregate>
+auto sort_aggregate(ForwardIt first, ForwardIt last, Key key, Reducer reducer, Aggregate init)
+    -> std::vector<std::pair<std::decay_t<std::invoke_result_t<Key&, std::iter_reference_t<ForwardIt>>>,
+                             Aggregate>> {
+    using key_type = std::decay_t<std::invoke_result_t<Key&, std::iter_reference_t<ForwardIt>>>;
+    std::vector<std::pair<key_type, Aggregate>> groups;
+
+    // Folds the next element of the merged sequence into the last group,
+    // or starts a group if its key is new
+    auto fold = [&](const auto& element) {
+        decltype(auto) k = std::invoke(key, element);
+        if (!groups.empty() && !(groups.back().first < k)) {
+            groups.back().second = std::invoke(reducer, std::move(groups.back().second), element);
+        } else {
+            groups.emplace_back(k, std::invoke(reducer, init, element));
+        }
+    };
+
+    if constexpr (!std::random_access_iterator<ForwardIt>) {
+        // Each half's sort hands back where it ends, so the list is only
+        // walked once, to count it
+        auto by_key = instrument_compare([&](const auto& a, const auto& b) {
+            return std::invoke(key, a) < std::invoke(key, b);
+        });
+        auto n = sort_detail::distance_counted(first, last);
+        ForwardIt middle = sort_detail::merge_sort_n(first, n / 2, by_key);
+        sort_detail::merge_sort_n(middle, n - n / 2, by_key);
+        ForwardIt left = first;
+        ForwardIt right = middle;
+        while (left != middle && right != last) {
+            if (std::invoke(key, *right) < std::invoke(key, *left)) {
+                fold(*right++);
+            } else {
+                fold(*left++);
+            }
+        }
+        std::for_each(left, middle, fold);
+        std::for_each(right, last, fold);
+    } else {
+        auto n = last - first;
+        if constexpr (std::contiguous_iterator<ForwardIt> && std::is_same_v<Key, std::identity>
+                      && sort_detail::is_radix_key_v<std::iter_value_t<ForwardIt>>) {
+            // Numbers grouped by their own value: fold during the last radix pass
+            if (n >= static_cast<std::ptrdiff_t>(sort_detail::radix_sort_size)) {
+                return sort_detail::radix_aggregate(std::to_address(first), static_cast<std::size_t>(n),
+                                                    reducer, init);
+            }
+        }
+        if (n < sort_detail::aggregate_merge_size) {
+            sort_detail::sort_by_key(first, last, key);
+            std::for_each(first, last, fold);
+            return groups;
+        }
+
+        auto middle = first + n / 2;
+        sort_detail::sort_by_key(first, middle, key);
+        sort_detail::sort_by_key(middle, last, key);
+        ForwardIt left = first;
+        ForwardIt right = middle;
+        while (left != middle && right != last) {
+            // Which side goes next is a coin flip on random input, so pick
+            // it without a branch
+            bool take_right = std::invoke(key, *right) < std::invoke(key, *left);
+            fold(take_right ? *right : *left);
+            right += take_right;
+            left += !take_right;
+        }
+        std::for_each(left, middle, fold);
+        std::for_each(right, last, fold);
+    }
+    return groups;
+}
+
+// As above, starting every group from a value-initialized aggregate whose
+// type is the reducer's first parameter
+template<typename ForwardIt, typename Key, typename Reducer>
+auto sort_aggregate(ForwardIt first, ForwardIt last, Key key, Reducer reducer) {
+    using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+    using aggregate_type = sort_detail::aggregate_type_t<Reducer, value_type>;
+    return sort_aggregate(first, last, std::move(key), std::move(reducer), aggregate_type{});
+}
+
+// Moves the k smallest elements of [first, last) to the front of the range,
+// where k = distance(first, middle), keeping the rest behind them in
+// unspecified order. A bounded max-heap of iterators finds the k-th
+// smallest value in one pass, so this costs O(n log k) time and O(k) memory.
+// Returns the end of the selected prefix (middle).
+template<typename ForwardIt, typename Compare>
+ForwardIt select_smallest(ForwardIt first, ForwardIt middle, ForwardIt last, Compare comp) {
+    auto k = static_cast<std::size_t>(sort_detail::distance_counted(first, middle));
+    if (k == 0) {
+        return first;
+    }
+
+    auto heap_comp = [&comp](const ForwardIt& a, const ForwardIt& b) { return comp(*a, *b); };
+    std::vector<ForwardIt> heap;
+    heap.reserve(k);
+    sort_detail::count_allocation<ForwardIt>(k);
+    for (auto it = first; it != last; ++it) {
+        if (heap.size() < k) {
+            heap.push_back(it);
+            std::push_heap(heap.begin(), heap.end(), heap_comp);
+        } else if (comp(*it, *heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), heap_comp);
+            heap.back() = it;
+            std::push_heap(heap.begin(), heap.end(), heap_comp);
+        }
+    }
+
+    // Everything below the threshold was kept; of the elements equal to it,
+    // only as many as the heap holds belong to the selection
+    using value_type = typename std::iterator_traits<ForwardIt>::value_type;
+    value_type threshold = *heap.front();
+    std::size_t equal_quota = 0;
+    for (const ForwardIt& it : heap) {
+        if (!comp(*it, threshold)) {
+            ++equal_quota;
+        }
+    }
+
+    // Forward-iterator partition of the selected elements to the front
+    auto out = first;
+    for (auto it = first; it != last; ++it) {
+        bool take = comp(*it, threshold);
+        if (!take && equal_quota != 0 && !comp(threshold, *it)) {
+            --equal_quota;
+            take = true;
+        }
+        if (take) {
+            if (it != out) {
+                std::iter_swap(it, out);
+            }
+            ++out;
+        }
+    }
+    return out;
+}
+
+// Unified partial_sort: [first, middle) ends up holding the smallest
+// elements of [first, last) in sorted order
+template<typename Iterator, typename Compare = std::less<>>
+void unified_partial_sort(Iterator first, Iterator middle, Iterator last, Compare user_comp = Compare{}) {
+    auto comp = instrument_compare(user_comp);
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, 
+                                    typename std::iterator_traits<Iterator>::iterator_category>) {
+        std::partial_sort(first, middle, last, comp);
+    } else {
+        // Only the k selected elements need sorting: O(n log k) overall
+        select_smallest(first, middle, last, comp);
+        unified_sort(first, middle, comp);
+    }
+}
+
+// Unified nth_element: *nth becomes the element a full sort would put
+// there, with no greater element before it and no smaller one after it
+template<typename Iterator, typename Compare = std::less<>>
+void unified_nth_element(Iterator first, Iterator nth, Iterator last, Compare user_comp = Compare{}) {
+    auto comp = instrument_compare(user_comp);
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, 
+                                    typename std::iterator_traits<Iterator>::iterator_category>) {
+        std::nth_element(first, nth, last, comp);
+    } else {
+        if (nth == last) {
+            return;
+        }
+        // Select the nth+1 smallest, then put the largest of them at nth
+        select_smallest(first, std::next(nth), last, comp);
+        std::iter_swap(std::max_element(first, std::next(nth), comp), nth);
+    }
+}
+
+namespace sort_detail {
+
+// Below this size per thread parallel_stable_sort runs serially
+inline constexpr std::ptrdiff_t parallel_sort_size = 1 << 15;
+
+// Number of elements of a that precede output position d when a and b
+// are stably merged (merge path partitioning)
+template<typename RandomIt, typename Compare>
+std::ptrdiff_t merge_path_split(RandomIt a, std::ptrdiff_t na, RandomIt b, std::ptrdiff_t nb,
+                                std::ptrdiff_t d, Compare& comp) {
+    std::ptrdiff_t lo = d > nb ? d - nb : 0;
+    std::ptrdiff_t hi = d < na ? d : na;
+    while (lo < hi) {
+        std::ptrdiff_t mid = lo + (hi - lo) / 2;
+        if (!comp(b[d - mid - 1], a[mid])) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Stably merges the sorted ranges [first, middle) and [middle, last) into
+// out using up to `threads` threads, each producing an equal share of the
+// output
+template<typename RandomIt, typename OutIt, typename Compare>
+void parallel_merge(RandomIt first, RandomIt middle, RandomIt last, OutIt out,
+                    Compare& comp, unsigned threads) {
+    std::ptrdiff_t na = middle - first;
+    std::ptrdiff_t nb = last - middle;
+    std::ptrdiff_t n = na + nb;
+
+    auto merge_share = [&](unsigned part) {
+        std::ptrdiff_t d0 = n * part / threads;
+        std::ptrdiff_t d1 = n * (part + 1) / threads;
+        std::ptrdiff_t i0 = merge_path_split(first, na, middle, nb, d0, comp);
+        std::ptrdiff_t i1 = merge_path_split(first, na, middle, nb, d1, comp);
+        std::merge(std::make_move_iterator(first + i0), std::make_move_iterator(first + i1),
+                   std::make_move_iterator(middle + (d0 - i0)),
+                   std::make_move_iterator(middle + (d1 - i1)),
+                   out + d0, comp);
+    };
+
+    std::vector<std::future<void>> parts;
+    for (unsigned part = 1; part < threads; ++part) {
+        parts.push_back(std::async(std::launch::async, merge_share, part));
+    }
+    merge_share(0);
+    for (auto& part : parts) {
+        part.get();
+    }
+}
+
+// Sorts [first, last) with `threads` threads; buffer has room for all of
+// its elements. Halves are sorted concurrently, then merged in parallel
+// into the buffer and moved back.
+template<typename RandomIt, typename BufferIt, typename Compare>
+void parallel_stable_sort(RandomIt first, RandomIt last, BufferIt buffer,
+                          Compare& comp, unsigned threads) {
+    std::ptrdiff_t n = last - first;
+    if (threads < 2 || n < 2 * parallel_sort_size) {
+        stable_merge_sort(first, n, buffer, comp);
+        return;
+    }
+
+    std::ptrdiff_t half = n / 2;
+    RandomIt middle = first + half;
+    unsigned left_threads = threads / 2;
+    auto left = std::async(std::launch::async, [&] {
+        parallel_stable_sort(first, middle, buffer, comp, left_threads);
+    });
+    parallel_stable_sort(middle, last, buffer + half, comp, threads - left_threads);
+    left.get();
+
+    if (!comp(*middle, *(middle - 1))) {
+        return;
+    }
+    parallel_merge(first, middle, last, buffer, comp, threads);
+
+    // Move back in parallel as well, one share per thread
+    auto move_share = [&](unsigned part) {
+        std::ptrdiff_t d0 = n * part / threads;
+        std::ptrdiff_t d1 = n * (part + 1) / threads;
+        std::move(buffer + d0, buffer + d1, first + d0);
+    };
+    std::vector<std::future<void>> parts;
+    for (unsigned part = 1; part < threads; ++part) {
+        parts.push_back(std::async(std::launch::async, move_share, part));
+    }
+    move_share(0);
+    for (auto& part : parts) {
+        part.get();
+    }
+}
+
+} // namespace sort_detail
+
+// Stable sort for any forward range: equal elements keep their relative
+// order, so records can be sorted key by key in successive passes. One
+// scratch buffer of n / 2 elements is allocated up front and reused by
+// every merge. Elements must be default constructible.
+template<typename ForwardIt, typename Compare = std::less<>>
+void serial_stable_sort(ForwardIt first, ForwardIt last, Compare comp = Compare{}) {
+    auto counted = instrument_compare(comp);
+    sort_detail::merge_sort_n(first, sort_detail::distance_counted(first, last), counted);
+}
+
+// Stable sort of a random-access range on up to `threads` threads. Both
+// the sorting of the halves and the final merges run in parallel; merges
+// are split by merge path so each thread writes an equal share of the
+// output. One buffer of n elements is allocated up front and shared by
+// all levels and threads.
+template<typename RandomIt, typename Compare = std::less<>>
+void parallel_stable_sort(RandomIt first, RandomIt last, Compare comp = Compare{},
+                          unsigned threads = std::thread::hardware_concurrency()) {
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+                                    typename std::iterator_traits<RandomIt>::iterator_category>,
+                  "parallel_stable_sort needs random-access iterators");
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    auto n = last - first;
+    auto counted = instrument_compare(comp);
+    if (threads < 2 || n < 2 * sort_detail::parallel_sort_size) {
+        serial_stable_sort(first, last, counted);
+        return;
+    }
+    std::vector<value_type> buffer(n);
+    sort_detail::count_allocation<value_type>(buffer.size());
+    sort_detail::parallel_stable_sort(first, last, buffer.begin(), counted, threads);
+}
+
+// Unified stable sort: stable on every iterator category, parallel for
+// random-access ranges
+template<typename Iterator, typename Compare = std::less<>>
+void unified_stable_sort(Iterator first, Iterator last, Compare comp = Compare{}) {
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, 
+                                    typename std::iterator_traits<Iterator>::iterator_category>) {
+        parallel_stable_sort(first, last, comp);
+    } else {
+        serial_stable_sort(first, last, comp);
+    }
+}
+
+namespace sort_detail {
+
+// Tournament (loser) tree over k sorted sources. Each leaf holds a pointer
+// to the current head of its source, or nullptr once the source is
+// exhausted; every internal node remembers the loser of the match played
+// there, so replacing the winner replays only the log k matches on its
+// path to the root. Ties go to the source with the lower index, which makes
+// the merge stable.
+template<typename T, typename Compare>
+class loser_tree {
+public:
+    loser_tree(const std::vector<const T*>& heads, Compare& comp)
+        : k_(heads.size()), tree_(std::max<std::size_t>(k_, 1)), comp_(comp) {
+        if (k_ == 0) {
+            return;
+        }
+        // winners[node] is the winner of the subtree at node; leaves are
+        // nodes k .. 2k-1
+        std::vector<entry> winners(2 * k_);
+        for (std::size_t i = 0; i < k_; ++i) {
+            winners[k_ + i] = entry{heads[i], i};
+        }
+        for (std::size_t node = k_ - 1; node >= 1; --node) {
+            const entry& a = winners[2 * node];
+            const entry& b = winners[2 * node + 1];
+            if (beats(a, b)) {
+                winners[node] = a;
+                tree_[node] = b;
+            } else {
+                winners[node] = b;
+                tree_[node] = a;
+            }
+        }
+        tree_[0] = winners[1];
+    }
+
+    bool empty() const { return tree_[0].head == nullptr; }
+
+    // Source holding the smallest head
+    std::size_t top() const { return tree_[0].source; }
+    const T& top_value() const { return *tree_[0].head; }
+
+    // Gives the winning source a new head (nullptr when it ran out)
+    void replace_top(const T* head) {
+        entry winner{head, tree_[0].source};
+        for (std::size_t node = (k_ + winner.source) / 2; node >= 1; node /= 2) {
+            // Written without a branch: which side wins is unpredictable
+            entry other = tree_[node];
+            bool swap = beats(other, winner);
+            tree_[node] = swap ? winner : other;
+            winner = swap ? other : winner;
+        }
+        tree_[0] = winner;
+    }
+
+private:
+    // Losers are kept together with their heads, so replaying a path
+    // touches one array only
+    struct entry {
+        const T* head = nullptr;
+        std::size_t source = 0;
+    };
+
+    // True if a's head goes before b's
+    bool beats(const entry& a, const entry& b) const {
+        if (a.head == nullptr) {
+            return b.head == nullptr && a.source < b.source;
+        }
+        if (b.head == nullptr) {
+            return true;
+        }
+        // On ties the lower index wins, so one comparison decides
+        return a.source < b.source ? !comp_(*b.head, *a.head) : comp_(*a.head, *b.head);
+    }
+
+    std::size_t k_;
+    std::vector<entry> tree_;
+    Compare& comp_;
+};
+
+template<typename Iterator>
+auto head_of(Iterator it, Iterator end) -> decltype(std::addressof(*it)) {
+    return it == end ? nullptr : std::addressof(*it);
+}
+
+// Merges sources [begins[i], ends[i]) into out
+template<typename Iterator, typename OutIt, typename Compare>
+OutIt merge_sources(std::vector<Iterator> begins, const std::vector<Iterator>& ends,
+                    OutIt out, Compare& comp) {
+    using value_type = typename std::iterator_traits<Iterator>::value_type;
+    std::vector<const value_type*> heads;
+    heads.reserve(begins.size());
+    for (std::size_t i = 0; i < begins.size(); ++i) {
+        heads.push_back(head_of(begins[i], ends[i]));
+    }
+    loser_tree<value_type, Compare> tree(heads, comp);
+    while (!tree.empty()) {
+        std::size_t source = tree.top();
+        *out++ = tree.top_value();
+        tree.replace_top(head_of(++begins[source], ends[source]));
+    }
+    return out;
+}
+
+// Advances source I of a tuple of (begin, end) pairs; returns its new head
+template<std::size_t I, typename Cursors, typename T>
+const T* advance_cursor(Cursors& cursors) {
+    auto& [it, end] = std::get<I>(cursors);
+    ++it;
+    return head_of(it, end);
+}
+
+template<typename T, typename Cursors, typename OutIt, typename Compare, std::size_t... Is>
+OutIt merge_cursors(Cursors& cursors, OutIt out, Compare& comp, std::index_sequence<Is...>) {
+    // One entry per source, so advancing a source picked at run time is
+    // a single indirect call
+    using advance_fn = const T* (*)(Cursors&);
+    static constexpr advance_fn advance[] = {&advance_cursor<Is, Cursors, T>...};
+
+    std::vector<const T*> heads = {
+        head_of(std::get<Is>(cursors).first, std::get<Is>(cursors).second)...};
+    loser_tree<T, Compare> tree(heads, comp);
+    while (!tree.empty()) {
+        std::size_t source = tree.top();
+        *out++ = tree.top_value();
+        tree.replace_top(advance[source](cursors));
+    }
+    return out;
+}
+
+} // namespace sort_detail
+
+// K-way merge of sorted ranges in a single pass: every element is compared
+// about log k times on its way through a loser tree, where repeated
+// pairwise merging would copy it log k times. Equal elements come out in
+// the order of the ranges that hold them.
+//
+// shards is any range of sorted ranges of the same type, such as
+// std::vector<std::list<int>>.
+template<typename Shards, typename OutIt, typename Compare = std::less<>>
+OutIt unified_merge(const Shards& shards, OutIt out, Compare comp = Compare{}) {
+    using iterator = std::ranges::iterator_t<const std::ranges::range_value_t<Shards>>;
+    std::vector<iterator> begins;
+    std::vector<iterator> ends;
+    for (const auto& shard : shards) {
+        begins.push_back(std::ranges::begin(shard));
+        ends.push_back(std::ranges::end(shard));
+    }
+    return sort_detail::merge_sources(std::move(begins), ends, out, comp);
+}
+
+// Heterogeneous k-way merge: shards is a tuple of sorted ranges that may
+// have different iterator categories but the same element type, e.g.
+//     unified_merge(std::tie(a_list, a_vector, a_deque), out);
+template<typename... Ranges, typename OutIt, typename Compare = std::less<>>
+OutIt unified_merge(const std::tuple<Ranges...>& shards, OutIt out, Compare comp = Compare{}) {
+    using value_type = std::ranges::range_value_t<std::tuple_element_t<0, std::tuple<Ranges...>>>;
+    static_assert((std::is_same_v<std::ranges::range_value_t<Ranges>, value_type> && ...),
+                  "unified_merge needs ranges of one element type");
+    auto cursors = std::apply([](const auto&... shard) {
+        return std::make_tuple(std::make_pair(std::ranges::begin(shard), std::ranges::end(shard))...);
+    }, shards);
+    return sort_detail::merge_cursors<value_type>(cursors, out, comp,
+                                                  std::index_sequence_for<Ranges...>{});
+}
+
+// K-way merge of sorted lists that relinks nodes instead of copying them:
+// all elements end up at the back of out and the shards are left empty.
+template<typename Shards, typename T, typename Alloc, typename Compare = std::less<>>
+void unified_splice_merge(Shards& shards, std::list<T, Alloc>& out, Compare comp = Compare{}) {
+    std::vector<std::list<T, Alloc>*> lists;
+    std::vector<const T*> heads;
+    for (auto& shard : shards) {
+        static_assert(std::is_same_v<std::remove_cvref_t<decltype(shard)>, std::list<T, Alloc>>,
+                      "unified_splice_merge needs shards of the output's list type");
+        lists.push_back(&shard);
+        heads.push_back(sort_detail::head_of(shard.begin(), shard.end()));
+    }
+    sort_detail::loser_tree<T, Compare> tree(heads, comp);
+    while (!tree.empty()) {
+        std::list<T, Alloc>& shard = *lists[tree.top()];
+        out.splice(out.end(), shard, shard.begin());
+        tree.replace_top(sort_detail::head_of(shard.begin(), shard.end()));
+    }
+}
+
+// Parallel k-way merge of random-access shards into a random-access
+// output. Splitter values are sampled from the largest shard and located
+// in every shard by binary search, which cuts the merge into independent
+// pieces that each thread merges with its own loser tree into its own
+// slice of out. Pieces are equal in size unless the data has long runs of
+// equal keys.
+template<typename Shards, typename RandomIt, typename Compare = std::less<>>
+RandomIt unified_parallel_merge(const Shards& shards, RandomIt out, Compare comp = Compare{},
+                                unsigned threads = std::thread::hardware_concurrency()) {
+    using iterator = std::ranges::iterator_t<const std::ranges::range_value_t<Shards>>;
+    static_assert(std::random_access_iterator<iterator> && std::random_access_iterator<RandomIt>,
+                  "unified_parallel_merge needs random-access shards and output");
+
+    std::vector<iterator> begins;
+    std::vector<iterator> ends;
+    std::size_t largest = 0;
+    std::ptrdiff_t total = 0;
+    for (const auto& shard : shards) {
+        begins.push_back(std::ranges::begin(shard));
+        ends.push_back(std::ranges::end(shard));
+        if (ends.back() - begins.back() > ends[largest] - begins[largest]) {
+            largest = begins.size() - 1;
+        }
+        total += ends.back() - begins.back();
+    }
+    if (threads < 2 || total < 2 * sort_detail::parallel_sort_size) {
+        return sort_detail::merge_sources(std::move(begins), ends, out, comp);
+    }
+
+    // cuts[p][i] is where piece p starts in shard i; all elements of
+    // piece p compare less than the splitter that starts piece p + 1
+    std::size_t k = begins.size();
+    std::vector<std::vector<iterator>> cuts(threads + 1);
+    cuts[0] = begins;
+    cuts[threads] = ends;
+    std::ptrdiff_t largest_size = ends[largest] - begins[largest];
+    for (unsigned p = 1; p < threads; ++p) {
+        const auto& splitter = begins[largest][largest_size * p / threads];
+        cuts[p].resize(k);
+        for (std::size_t i = 0; i < k; ++i) {
+            // Never before the previous cut, so pieces cannot overlap
+            cuts[p][i] = std::lower_bound(cuts[p - 1][i], ends[i], splitter, comp);
+        }
+    }
+
+    std::vector<std::ptrdiff_t> offsets(threads + 1, 0);
+    for (unsigned p = 0; p < threads; ++p) {
+        offsets[p + 1] = offsets[p];
+        for (std::size_t i = 0; i < k; ++i) {
+            offsets[p + 1] += cuts[p + 1][i] - cuts[p][i];
+        }
+    }
+
+    auto merge_piece = [&](unsigned p) {
+        sort_detail::merge_sources(cuts[p], cuts[p + 1], out + offsets[p], comp);
+    };
+    std::vector<std::future<void>> pieces;
+    for (unsigned p = 1; p < threads; ++p) {
+        pieces.push_back(std::async(std::launch::async, merge_piece, p));
+    }
+    merge_piece(0);
+    for (auto& piece : pieces) {
+        piece.get();
+    }
+    return out + total;
+}
+
+#endif
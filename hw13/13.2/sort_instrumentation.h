@@ -0,0 +1,240 @@
+#ifndef SORT_INSTRUMENTATION_H
+#define SORT_INSTRUMENTATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Opt-in counters for the sort engines in sort.h. Build with
+// -DSORT_INSTRUMENTATION=1 to record, per recursion depth and per thread:
+//     comparisons      calls of the comparator passed to a sort
+//     moves, copies    constructions and assignments of instrumented<T>
+//     allocations      scratch buffers the engines allocate, and their bytes
+//     advance_steps    iterator steps taken by std::next / std::distance
+//                      on non-random-access iterators
+// Without it, instrumented<T> is T, instrument_compare returns the
+// comparator itself and every hook is an empty macro, so the engines
+// compile exactly as before.
+//
+//     sort_report_reset();
+//     std::forward_list<instrumented<int>> values = ...;
+//     unified_sort(values.begin(), values.end());
+//     write_sort_report(std::cout, "forward_list");
+//
+// write_sort_report prints one JSON object per line.
+
+#ifndef SORT_INSTRUMENTATION
+#define SORT_INSTRUMENTATION 0
+#endif
+
+// What one recursion depth did
+struct sort_counters {
+    std::uint64_t comparisons = 0;
+    std::uint64_t moves = 0;
+    std::uint64_t copies = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes_allocated = 0;
+    std::uint64_t advance_steps = 0;
+
+    sort_counters& operator+=(const sort_counters& other) {
+        comparisons += other.comparisons;
+        moves += other.moves;
+        copies += other.copies;
+        allocations += other.allocations;
+        bytes_allocated += other.bytes_allocated;
+        advance_steps += other.advance_steps;
+        return *this;
+    }
+};
+
+#if SORT_INSTRUMENTATION
+
+namespace sort_detail {
+
+// Counters of the calling thread, indexed by recursion depth
+struct sort_probe {
+    std::vector<sort_counters> depths = std::vector<sort_counters>(1);
+    std::size_t depth = 0;
+
+    sort_counters& here() {
+        if (depth >= depths.size()) {
+            depths.resize(depth + 1);
+        }
+        return depths[depth];
+    }
+};
+
+inline thread_local sort_probe probe;
+
+// Attributes everything in its scope to one level deeper
+struct depth_scope {
+    depth_scope() { ++probe.depth; }
+    ~depth_scope() { --probe.depth; }
+    depth_scope(const depth_scope&) = delete;
+    depth_scope& operator=(const depth_scope&) = delete;
+};
+
+// Forwards to the wrapped comparator and counts the call
+template<typename Compare>
+struct counted_compare {
+    Compare comp;
+
+    template<typename A, typename B>
+    bool operator()(A&& a, B&& b) {
+        ++probe.here().comparisons;
+        return comp(std::forward<A>(a), std::forward<B>(b));
+    }
+};
+
+template<typename Compare>
+struct is_counted_compare : std::false_type {
+};
+
+template<typename Compare>
+struct is_counted_compare<counted_compare<Compare>> : std::true_type {
+};
+
+} // namespace sort_detail
+
+#define SORT_COUNT(field, amount) (::sort_detail::probe.here().field += (amount))
+#define SORT_DEPTH_SCOPE() ::sort_detail::depth_scope sort_depth_scope_guard
+
+// An element whose copies and moves are counted
+template<typename T>
+class instrumented {
+public:
+    instrumented() = default;
+    instrumented(T v) : value(std::move(v)) {}
+    instrumented(const instrumented& other) : value(other.value) { SORT_COUNT(copies, 1); }
+    instrumented(instrumented&& other) noexcept : value(std::move(other.value)) { SORT_COUNT(moves, 1); }
+
+    instrumented& operator=(const instrumented& other) {
+        SORT_COUNT(copies, 1);
+        value = other.value;
+        return *this;
+    }
+
+    instrumented& operator=(instrumented&& other) noexcept {
+        SORT_COUNT(moves, 1);
+        value = std::move(other.value);
+        return *this;
+    }
+
+    operator const T&() const { return value; }
+
+    friend bool operator==(const instrumented& a, const instrumented& b) { return a.value == b.value; }
+    friend auto operator<=>(const instrumented& a, const instrumented& b) { return a.value <=> b.value; }
+
+    friend std::ostream& operator<<(std::ostream& out, const instrumented& v) { return out << v.value; }
+
+private:
+    T value{};
+};
+
+// The comparator with its calls counted; a comparator that is counted
+// already is returned as is, so nested engines do not count twice
+template<typename Compare>
+auto instrument_compare(Compare comp) {
+    if constexpr (sort_detail::is_counted_compare<Compare>::value) {
+        return comp;
+    } else {
+        return sort_detail::counted_compare<Compare>{std::move(comp)};
+    }
+}
+
+// Counters of this thread so far, one entry per recursion depth
+inline std::vector<sort_counters> sort_report_snapshot() {
+    return sort_detail::probe.depths;
+}
+
+inline void sort_report_reset() {
+    sort_detail::probe.depths.assign(1, sort_counters{});
+}
+
+#else
+
+#define SORT_COUNT(field, amount) ((void)0)
+#define SORT_DEPTH_SCOPE() ((void)0)
+
+template<typename T>
+using instrumented = T;
+
+template<typename Compare>
+Compare instrument_compare(Compare comp) {
+    return comp;
+}
+
+inline std::vector<sort_counters> sort_report_snapshot() {
+    return {};
+}
+
+inline void sort_report_reset() {
+}
+
+#endif
+
+namespace sort_detail {
+
+// std::next and std::distance with the steps counted when they walk
+template<typename Iterator>
+Iterator next_counted(Iterator it, std::ptrdiff_t n = 1) {
+    if constexpr (!std::random_access_iterator<Iterator>) {
+        SORT_COUNT(advance_steps, static_cast<std::uint64_t>(n < 0 ? -n : n));
+    }
+    return std::next(it, n);
+}
+
+template<typename Iterator>
+std::ptrdiff_t distance_counted(Iterator first, Iterator last) {
+    auto n = std::distance(first, last);
+    if constexpr (!std::random_access_iterator<Iterator>) {
+        SORT_COUNT(advance_steps, static_cast<std::uint64_t>(n));
+    }
+    return static_cast<std::ptrdiff_t>(n);
+}
+
+// Records a scratch allocation of n elements of T
+template<typename T>
+void count_allocation([[maybe_unused]] std::size_t n) {
+    SORT_COUNT(allocations, 1);
+    SORT_COUNT(bytes_allocated, n * sizeof(T));
+}
+
+} // namespace sort_detail
+
+// Writes this thread's counters as one line of JSON:
+//     {"label":"...","enabled":true,"depths":[{"depth":0,...},...],"total":{...}}
+inline void write_sort_report(std::ostream& out, const std::string& label) {
+    auto fields = [&out](const sort_counters& c) {
+        out << "\"comparisons\":" << c.comparisons << ",\"moves\":" << c.moves
+            << ",\"copies\":" << c.copies << ",\"allocations\":" << c.allocations
+            << ",\"bytes_allocated\":" << c.bytes_allocated
+            << ",\"advance_steps\":" << c.advance_steps;
+    };
+    std::vector<sort_counters> depths = sort_report_snapshot();
+    sort_counters total;
+    out << "{\"label\":\"";
+    for (char c : label) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << "\",\"enabled\":" << (SORT_INSTRUMENTATION ? "true" : "false") << ",\"depths\":[";
+    for (std::size_t d = 0; d < depths.size(); ++d) {
+        out << (d == 0 ? "" : ",") << "{\"depth\":" << d << ",";
+        fields(depths[d]);
+        out << "}";
+        total += depths[d];
+    }
+    out << "],\"total\":{";
+    fields(total);
+    out << "}}\n";
+}
+
+#endif
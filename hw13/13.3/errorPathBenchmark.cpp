@@ -0,0 +1,91 @@
+#include "my_promoise.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mpcs;
+using namespace std;
+
+// Error-path throughput of MyPromise: every request fails, the way they
+// do under overload. The exception path throws and catches to get an
+// exception_ptr for set_exception, and the consumer's get() rethrows it.
+// The typed path sets an error code and reads it with try_get().
+//
+//     errorPathBenchmark [requests per thread] [threads]
+//
+// Defaults to 1000000 requests on one thread. With several threads the
+// unwinders run concurrently, which is where exceptions cost the most.
+
+enum class ErrorCode { overloaded, timed_out };
+
+long long exceptionPath(size_t requests) {
+    long long failures = 0;
+    for (size_t i = 0; i < requests; ++i) {
+        MyPromise<int> promise;
+        auto future = promise.get_future();
+        try {
+            throw runtime_error("overloaded");
+        } catch (exception&) {
+            promise.set_exception(current_exception());
+        }
+        try {
+            failures -= future.get();
+        } catch (runtime_error&) {
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+long long typedPath(size_t requests) {
+    long long failures = 0;
+    for (size_t i = 0; i < requests; ++i) {
+        MyPromise<int, ErrorCode> promise;
+        auto future = promise.get_future();
+        promise.set_error(ErrorCode::overloaded);
+        auto result = future.try_get();
+        if (result) {
+            failures -= *result;
+        } else {
+            failures += result.error() == ErrorCode::overloaded;
+        }
+    }
+    return failures;
+}
+
+template<typename Path>
+void time(const string& label, Path path, size_t requests, size_t threads) {
+    vector<long long> failures(threads);
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] { failures[t] = path(requests); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    long long total = 0;
+    for (long long f : failures) {
+        total += f;
+    }
+    if (total != static_cast<long long>(requests * threads)) {
+        cerr << label << ": lost failures" << endl;
+        exit(1);
+    }
+    cout << label << " took " << elapsed.count() << " ms ("
+         << total / elapsed.count() * 1e3 << " failures/s)" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t requests = argc > 1 ? stoul(argv[1]) : 1000000;
+    size_t threads = argc > 2 ? stoul(argv[2]) : 1;
+    cout << requests << " failing requests on each of " << threads << " thread(s)" << endl;
+    time("exception_ptr + get()", exceptionPath, requests, threads);
+    time("error code + try_get()", typedPath, requests, threads);
+    return 0;
+}
@@ -0,0 +1,80 @@
+#ifndef EXPECTED_H
+#define EXPECTED_H
+
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#if defined(__has_include)
+#if __has_include(<expected>)
+#include <expected>
+#endif
+#endif
+
+namespace mpcs {
+
+#if defined(__cpp_lib_expected)
+
+template<class T, class E>
+using expected = std::expected<T, E>;
+
+template<class E>
+using unexpected = std::unexpected<E>;
+
+#else
+
+// Stand-in for C++23 std::expected, only as much of it as MyFuture::try_get
+// needs: either a value or an error, with no exceptions involved in
+// building or inspecting it. Replaced by std::expected where the library
+// has it.
+template<class E>
+class unexpected {
+public:
+    explicit unexpected(E e) : err(std::move(e)) {}
+
+    E& error() & { return err; }
+    const E& error() const& { return err; }
+    E&& error() && { return std::move(err); }
+
+private:
+    E err;
+};
+
+template<class E>
+unexpected(E) -> unexpected<E>;
+
+template<class T, class E>
+class expected {
+public:
+    expected(T value) : storage(std::in_place_index<0>, std::move(value)) {}
+    expected(unexpected<E> e) : storage(std::in_place_index<1>, std::move(e).error()) {}
+
+    bool has_value() const noexcept { return storage.index() == 0; }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    // Like operator* on std::expected, these assume has_value()
+    T& operator*() & noexcept { return *std::get_if<0>(&storage); }
+    const T& operator*() const& noexcept { return *std::get_if<0>(&storage); }
+    T&& operator*() && noexcept { return std::move(*std::get_if<0>(&storage)); }
+    T* operator->() noexcept { return std::get_if<0>(&storage); }
+    const T* operator->() const noexcept { return std::get_if<0>(&storage); }
+
+    // Assumes !has_value()
+    E& error() & noexcept { return *std::get_if<1>(&storage); }
+    const E& error() const& noexcept { return *std::get_if<1>(&storage); }
+    E&& error() && noexcept { return std::move(*std::get_if<1>(&storage)); }
+
+    template<class U>
+    T value_or(U&& fallback) const& {
+        return has_value() ? **this : static_cast<T>(std::forward<U>(fallback));
+    }
+
+private:
+    std::variant<T, E> storage;
+};
+
+#endif
+
+}
+
+#endif
@@ -1,4 +1,4 @@
-#include "my_promise.h"
+#include "my_promoise.h"
 #include <thread>
 #include <iostream>
 #include <stdexcept>
@@ -52,6 +52,15 @@ int main()
     cout << "Main thread waiting for consumer to finish..." << endl;
     thr.join();
     
+    // A typed error needs no throw on either side
+    enum class Status { overloaded };
+    MyPromise<int, Status> typed;
+    auto typedFuture = typed.get_future();
+    typed.set_error(Status::overloaded);
+    if (auto result = typedFuture.try_get(); !result) {
+        cout << "Typed error received: " << (result.error() == Status::overloaded ? "overloaded" : "?") << endl;
+    }
+
     cout << "Program completed successfully" << endl;
     return 0;
 }
\ No newline at end of file
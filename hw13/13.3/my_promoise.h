@@ -1,6 +1,7 @@
 #ifndef MY_PROMISE_H
 #define MY_PROMISE_H
 
+#include "expected.h"
 #include <optional>
 #include <variant>
 #include <memory>
@@ -8,6 +9,7 @@
 #include <stdexcept>
 #include <atomic>
 #include <functional>
+#include <type_traits>
 
 namespace mpcs {
 
@@ -18,13 +20,31 @@ struct overloaded : Ts... {
 };
 template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 
-template<class T> class MyPromise;
+// E is what a failure is delivered as. The default, std::exception_ptr,
+// is the classic promise: set_exception and a get() that rethrows. Any
+// other E is a typed error code set with set_error and read back with
+// try_get(), without throwing or catching anything.
+template<class T, class E = std::exception_ptr> class MyPromise;
+template<class T, class E = std::exception_ptr> class MyFuture;
 
-// Using variant to hold either a value or an exception
-template<class T>
+// Thrown by get() on a future with a typed error, for callers that do
+// want an exception; try_get() reports the same error without one
+template<class E>
+class FutureError : public std::runtime_error {
+public:
+    explicit FutureError(E e) : std::runtime_error{"Future completed with an error"}, err(std::move(e)) {}
+    const E& error() const noexcept { return err; }
+
+private:
+    E err;
+};
+
+// Using variant to hold either a value or an error
+template<class T, class E = std::exception_ptr>
 struct SharedState {
-    // use std::variant to store either a value of type T or an exception_ptr
-    using ValueVariant = std::variant<std::monostate, T, std::exception_ptr>;
+    // use std::variant to store either a value of type T or an error (by default an exception_ptr)
+    using ValueVariant = std::variant<std::monostate, T, E>;
+    static_assert(!std::is_same_v<T, E>, "the error type must differ from the value type");
     
     std::atomic<bool> ready{false};
     std::atomic<bool> consumer_waiting{false};
@@ -57,9 +77,11 @@ struct SharedState {
     }
 };
 
-template<typename T>
+template<typename T, typename E>
 class MyFuture {
 public:
+    static constexpr bool throws_errors = std::is_same_v<E, std::exception_ptr>;
+
     MyFuture(const MyFuture&) = delete;
     MyFuture(MyFuture&&) = default;
     
@@ -73,11 +95,29 @@ public:
             [](T& value) -> T {
                 return std::move(value);
             },
-            [](std::exception_ptr& exc) -> T {
-                std::rethrow_exception(exc);
+            [](E& err) -> T {
+                if constexpr (throws_errors) {
+                    std::rethrow_exception(err);
+                } else {
+                    throw FutureError<E>{std::move(err)};
+                }
             }
         }, sharedState->value);
     }
+
+    // Waits like get(), but hands back the value or the error instead of
+    // throwing. With the default E that error is the exception_ptr, still
+    // unthrown.
+    expected<T, E> try_get() noexcept(std::is_nothrow_move_constructible_v<T>
+                                      && std::is_nothrow_move_constructible_v<E>) {
+        sharedState->wait();
+
+        // Once ready, value holds T or E; monostate only before notify()
+        if (T* value = std::get_if<T>(&sharedState->value)) {
+            return std::move(*value);
+        }
+        return unexpected<E>{std::move(*std::get_if<E>(&sharedState->value))};
+    }
     
     bool is_ready() const {
         // Use acquire to ensure we see any updates to the value if ready is true
@@ -85,15 +125,15 @@ public:
     }
 
 private:
-    friend class MyPromise<T>;
-    explicit MyFuture(std::shared_ptr<SharedState<T>>& state) : sharedState(state) {}
-    std::shared_ptr<SharedState<T>> sharedState;
+    friend class MyPromise<T, E>;
+    explicit MyFuture(std::shared_ptr<SharedState<T, E>>& state) : sharedState(state) {}
+    std::shared_ptr<SharedState<T, E>> sharedState;
 };
 
-template<typename T>
+template<typename T, typename E>
 class MyPromise {
 public:
-    MyPromise() : sharedState{std::make_shared<SharedState<T>>()} {}
+    MyPromise() : sharedState{std::make_shared<SharedState<T, E>>()} {}
     
     void set_value(T value) {
         // Can use relaxed here as we're just checking, not synchronizing
@@ -105,18 +145,22 @@ public:
         sharedState->notify();
     }
     
-    void set_exception(std::exception_ptr exc) {
+    void set_exception(std::exception_ptr exc) requires std::is_same_v<E, std::exception_ptr> {
+        set_error(std::move(exc));
+    }
+    
+    void set_error(E err) {
         // Can use relaxed here as we're just checking, not synchronizing
         if (sharedState->ready.load(std::memory_order_relaxed)) {
             throw std::runtime_error{"Promise value already set"};
         }
         
-        sharedState->value = exc;
+        sharedState->value.template emplace<2>(std::move(err));
         sharedState->notify();
     }
     
-    MyFuture<T> get_future() {
-        return MyFuture<T>{sharedState};
+    MyFuture<T, E> get_future() {
+        return MyFuture<T, E>{sharedState};
     }
     
     bool has_consumer() const {
@@ -125,7 +169,7 @@ public:
     }
 
 private:
-    std::shared_ptr<SharedState<T>> sharedState;
+    std::shared_ptr<SharedState<T, E>> sharedState;
 };
 
 }
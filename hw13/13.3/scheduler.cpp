@@ -0,0 +1,104 @@
+#include "scheduler.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mpcs;
+using namespace std;
+using namespace std::chrono;
+
+// Batch producers keep the workers saturated with long tasks while a
+// client submits short interactive requests with a tight deadline. The
+// same load runs twice: once with the requests in the interactive class,
+// and once with them queued as batch work. In the second run the
+// requests share a class with the batch tasks, but their deadlines still
+// put them ahead of every queued batch task with a later one.
+
+// Burns roughly the given time on the CPU
+long spin(microseconds duration) {
+    long iterations = 0;
+    auto end = steady_clock::now() + duration;
+    while (steady_clock::now() < end) {
+        ++iterations;
+    }
+    return iterations;
+}
+
+void printStats(const string& label, const ClassStats& stats) {
+    cout << setw(22) << label << setw(10) << stats.completed << setw(8) << stats.missed_deadlines
+         << fixed << setprecision(1) << setw(12) << stats.mean_us << setw(12) << stats.p99_us
+         << setw(12) << stats.max_us << endl;
+}
+
+void run(bool prioritize) {
+    constexpr int producers = 2;
+    constexpr int batchTasks = 2000;
+    constexpr int requests = 200;
+
+    PriorityScheduler scheduler;
+    vector<thread> threads;
+    vector<vector<MyFuture<long>>> batchResults(producers);
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&scheduler, &results = batchResults[p]] {
+            for (int i = 0; i < batchTasks; ++i) {
+                results.push_back(scheduler.submit(Priority::batch, seconds(10),
+                                                   [] { return spin(microseconds(200)); }));
+            }
+        });
+    }
+
+    vector<MyFuture<long>> replies;
+    Priority requestClass = prioritize ? Priority::interactive : Priority::batch;
+    for (int i = 0; i < requests; ++i) {
+        replies.push_back(scheduler.submit(requestClass, milliseconds(2),
+                                           [] { return spin(microseconds(20)); }));
+        this_thread::sleep_for(milliseconds(1));
+    }
+    for (auto& reply : replies) {
+        reply.get();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto& results : batchResults) {
+        for (auto& result : results) {
+            result.get();
+        }
+    }
+
+    auto stats = scheduler.stats();
+    if (prioritize) {
+        printStats("interactive", stats[size_t(Priority::interactive)]);
+        printStats("batch", stats[size_t(Priority::batch)]);
+    } else {
+        printStats("everything as batch", stats[size_t(Priority::batch)]);
+    }
+}
+
+int main() {
+    // Results and exceptions come back through MyFuture
+    {
+        PriorityScheduler scheduler(2);
+        auto answer = scheduler.submit(Priority::normal, milliseconds(10), [] { return 6 * 7; });
+        auto failure = scheduler.submit(Priority::normal, milliseconds(10), []() -> int {
+            throw runtime_error("task failed");
+        });
+        cout << "answer: " << answer.get() << endl;
+        try {
+            failure.get();
+        } catch (exception& e) {
+            cout << "failure: " << e.what() << endl;
+        }
+    }
+
+    cout << "\nQueueing delay with " << thread::hardware_concurrency() << " worker(s), in us" << endl;
+    cout << setw(22) << "class" << setw(10) << "tasks" << setw(8) << "missed"
+         << setw(12) << "mean" << setw(12) << "p99" << setw(12) << "max" << endl;
+    run(true);
+    run(false);
+    return 0;
+}
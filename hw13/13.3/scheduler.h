@@ -0,0 +1,312 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "my_promoise.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mpcs {
+
+// Bounded multi-producer multi-consumer queue (Vyukov). Every cell
+// carries a sequence number telling producers and consumers whose turn it
+// is, so push and pop each claim a slot with one compare-and-swap and never
+// take a lock.
+template<typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(std::size_t capacity)
+        : mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+          cells(std::make_unique<Cell[]>(mask + 1)) {
+        for (std::size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_push(T value) {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& value) {
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value{};
+    };
+
+    const std::size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    // Producers and consumers each get their own cache line
+    alignas(64) std::atomic<std::size_t> tail{0};
+    alignas(64) std::atomic<std::size_t> head{0};
+};
+
+// Scheduling classes, most urgent first
+enum class Priority : std::size_t { interactive, normal, batch };
+inline constexpr std::size_t priority_count = 3;
+
+// Queueing delay of one scheduling class: the time from submit() until a
+// worker starts the task
+struct ClassStats {
+    std::uint64_t completed = 0;
+    std::uint64_t missed_deadlines = 0;
+    double mean_us = 0;
+    double p99_us = 0; // upper bound of the histogram bucket holding the 99th percentile
+    double max_us = 0;
+};
+
+// Runs tasks on a fixed pool of worker threads and hands their results
+// back through MyFutures. Workers always serve the most urgent class that
+// has work, and within a class start the queued task with the earliest
+// deadline. Each class admits tasks through its own lock-free queue, so
+// submit() never blocks on a worker; a worker looking for work moves
+// everything admitted so far into the class's deadline heap, under the
+// class's lock, and takes the heap's top.
+class PriorityScheduler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t queue_capacity = 1 << 16;
+    static constexpr std::size_t delay_buckets = 40;
+
+    explicit PriorityScheduler(unsigned workers = std::thread::hardware_concurrency()) {
+        for (std::size_t c = 0; c < priority_count; ++c) {
+            classes[c].admitted = std::make_unique<MpmcQueue<Task*>>(queue_capacity);
+        }
+        for (unsigned i = 0; i < std::max(workers, 1u); ++i) {
+            threads.emplace_back([this] { work(); });
+        }
+    }
+
+    PriorityScheduler(const PriorityScheduler&) = delete;
+    PriorityScheduler& operator=(const PriorityScheduler&) = delete;
+
+    // Runs every task already submitted, then stops the workers
+    ~PriorityScheduler() {
+        stopping.store(true, std::memory_order_release);
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Queues f to run at the given priority; queued tasks of one class
+    // are started earliest deadline first. An exception thrown by f is
+    // delivered through the future.
+    template<typename F>
+    auto submit(Priority priority, clock::time_point deadline, F f)
+        -> MyFuture<std::invoke_result_t<F&>> {
+        using R = std::invoke_result_t<F&>;
+        static_assert(!std::is_void_v<R>, "MyPromise needs a value type; return one from the task");
+        auto task = std::make_unique<TaskImpl<F>>(std::move(f));
+        task->priority = static_cast<std::size_t>(priority);
+        task->deadline = deadline;
+        MyFuture<R> future = task->promise.get_future();
+
+        Task* raw = task.release();
+        raw->enqueued = clock::now();
+        Class& target = classes[raw->priority];
+        // Counted first, so a worker never takes a task it has not counted
+        target.pending.fetch_add(1, std::memory_order_relaxed);
+        while (!target.admitted->try_push(raw)) {
+            // Full: let the workers catch up
+            std::this_thread::yield();
+        }
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+        return future;
+    }
+
+    template<typename F>
+    auto submit(Priority priority, clock::duration relative_deadline, F f) {
+        return submit(priority, clock::now() + relative_deadline, std::move(f));
+    }
+
+    // Queueing delay per class, indexed by Priority
+    std::array<ClassStats, priority_count> stats() const {
+        std::array<ClassStats, priority_count> result;
+        for (std::size_t c = 0; c < priority_count; ++c) {
+            const Counters& counters = delays[c];
+            ClassStats& out = result[c];
+            out.completed = counters.completed.load(std::memory_order_relaxed);
+            out.missed_deadlines = counters.missed.load(std::memory_order_relaxed);
+            if (out.completed == 0) {
+                continue;
+            }
+            out.mean_us = counters.total_ns.load(std::memory_order_relaxed) / 1e3 / out.completed;
+            out.max_us = counters.max_ns.load(std::memory_order_relaxed) / 1e3;
+            std::uint64_t seen = 0;
+            for (std::size_t b = 0; b < delay_buckets; ++b) {
+                seen += counters.histogram[b].load(std::memory_order_relaxed);
+                if (seen * 100 >= out.completed * 99) {
+                    out.p99_us = std::min(static_cast<double>(std::uint64_t(1) << b) / 1e3, out.max_us);
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    struct Task {
+        std::size_t priority = 0;
+        clock::time_point deadline;
+        clock::time_point enqueued;
+        virtual void run() = 0;
+        virtual ~Task() = default;
+    };
+
+    template<typename F>
+    struct TaskImpl : Task {
+        F f;
+        MyPromise<std::invoke_result_t<F&>> promise;
+
+        explicit TaskImpl(F fn) : f(std::move(fn)) {}
+
+        void run() override {
+            try {
+                promise.set_value(f());
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }
+    };
+
+    // Bucket b counts delays in [2^(b-1), 2^b) nanoseconds
+    struct Counters {
+        std::atomic<std::uint64_t> completed{0};
+        std::atomic<std::uint64_t> missed{0};
+        std::atomic<std::uint64_t> total_ns{0};
+        std::atomic<std::uint64_t> max_ns{0};
+        std::array<std::atomic<std::uint64_t>, delay_buckets> histogram{};
+
+        void record(std::chrono::nanoseconds delay, bool late) {
+            auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(delay.count(), 0));
+            std::size_t bucket = std::min<std::size_t>(std::bit_width(ns), delay_buckets - 1);
+            completed.fetch_add(1, std::memory_order_relaxed);
+            total_ns.fetch_add(ns, std::memory_order_relaxed);
+            histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+            if (late) {
+                missed.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::uint64_t max = max_ns.load(std::memory_order_relaxed);
+            while (ns > max && !max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+            }
+        }
+    };
+
+    // Heap order: the earliest deadline on top
+    static bool runs_later(const Task* a, const Task* b) {
+        return a->deadline > b->deadline;
+    }
+
+    // Tasks of one priority class: admitted lock-free by submit(), then
+    // ordered by deadline in the heap, which only workers touch
+    struct Class {
+        std::unique_ptr<MpmcQueue<Task*>> admitted;
+        std::atomic<std::size_t> pending{0}; // being admitted, admitted or in the heap
+        std::mutex lock;
+        std::vector<Task*> heap;
+    };
+
+    // The earliest-deadline task of the most urgent class with work, or
+    // nullptr if every class is empty
+    Task* next_task() {
+        for (Class& c : classes) {
+            if (c.pending.load(std::memory_order_acquire) == 0) {
+                continue;
+            }
+            std::lock_guard<std::mutex> guard(c.lock);
+            Task* task;
+            while (c.admitted->try_pop(task)) {
+                c.heap.push_back(task);
+                std::push_heap(c.heap.begin(), c.heap.end(), runs_later);
+            }
+            if (c.heap.empty()) {
+                // Counted but still being pushed; try the other
+                // classes rather than wait for it
+                continue;
+            }
+            std::pop_heap(c.heap.begin(), c.heap.end(), runs_later);
+            task = c.heap.back();
+            c.heap.pop_back();
+            c.pending.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+        return nullptr;
+    }
+
+    void work() {
+        for (;;) {
+            std::uint32_t seen = signal.load(std::memory_order_acquire);
+            std::unique_ptr<Task> task(next_task());
+            if (!task) {
+                if (stopping.load(std::memory_order_acquire)) {
+                    return;
+                }
+                signal.wait(seen, std::memory_order_acquire);
+                continue;
+            }
+
+            auto start = clock::now();
+            delays[task->priority].record(start - task->enqueued, start > task->deadline);
+            task->run();
+        }
+    }
+
+    std::array<Class, priority_count> classes;
+    std::array<Counters, priority_count> delays;
+    std::atomic<std::uint32_t> signal{0};
+    std::atomic<bool> stopping{false};
+    std::vector<std::thread> threads;
+};
+
+}
+
+#endif
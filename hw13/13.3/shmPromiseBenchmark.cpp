@@ -0,0 +1,239 @@
+#include "shm_promise.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace mpcs;
+using namespace std;
+
+// Cost of handing a result from a worker process back to its parent. The
+// worker is forked, computes a vector of doubles plus a summary, and the
+// parent waits for it. Through ShmPromise the worker computes straight
+// into the shared segment and the parent reads it in place; through a
+// socketpair the same result is written by the child and read back into a
+// vector by the parent.
+//
+//     shmPromiseBenchmark [values] [rounds]
+//
+// Defaults to 1000000 values and 20 rounds. Each round forks a new worker.
+
+struct Summary {
+    uint64_t count;
+    double sum;
+    ShmSpan<double> values;
+};
+
+double load(size_t i) {
+    return static_cast<double>(i % 977) * 0.25 + static_cast<double>(i / 977);
+}
+
+double compute(double* out, size_t n) {
+    double sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = load(i);
+        sum += out[i];
+    }
+    return sum;
+}
+
+void check(const double* values, size_t n, double sum, double expected, const string& label) {
+    if (sum != expected) {
+        cerr << label << ": wrong sum" << endl;
+        exit(1);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (values[i] != load(i)) {
+            cerr << label << ": wrong value at " << i << endl;
+            exit(1);
+        }
+    }
+}
+
+void shmRound(size_t n, size_t round, double expected) {
+    string name = "/shmPromiseBenchmark." + to_string(getpid()) + "." + to_string(round);
+    auto promise = ShmPromise<Summary>::create(name, n * sizeof(double));
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw system_error{errno, generic_category(), "fork"};
+    }
+    if (pid == 0) {
+        try {
+            ShmSpan<double> values = promise.allocate<double>(n);
+            double sum = compute(promise.resolve(values).data(), n);
+            promise.set_value(Summary{n, sum, values});
+        } catch (...) {
+            promise.set_error(errc::not_enough_memory);
+        }
+        _exit(0);
+    }
+    auto future = ShmFuture<Summary>::open(name);
+    auto result = future.try_get();
+    if (!result) {
+        cerr << "shm worker failed: " << make_error_code(result.error()).message() << endl;
+        exit(1);
+    }
+    check(future.resolve(result->values).data(), result->count, result->sum, expected, "ShmPromise");
+    waitpid(pid, nullptr, 0);
+}
+
+void writeAll(int fd, const void* data, size_t bytes) {
+    auto p = static_cast<const char*>(data);
+    while (bytes != 0) {
+        ssize_t n = write(fd, p, bytes);
+        if (n < 0 && errno != EINTR) {
+            _exit(1);
+        }
+        if (n > 0) {
+            p += n;
+            bytes -= n;
+        }
+    }
+}
+
+bool readAll(int fd, void* data, size_t bytes) {
+    auto p = static_cast<char*>(data);
+    while (bytes != 0) {
+        ssize_t n = read(fd, p, bytes);
+        if (n == 0 || (n < 0 && errno != EINTR)) {
+            return false;
+        }
+        if (n > 0) {
+            p += n;
+            bytes -= n;
+        }
+    }
+    return true;
+}
+
+void socketRound(size_t n, double expected) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        throw system_error{errno, generic_category(), "socketpair"};
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw system_error{errno, generic_category(), "fork"};
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        vector<double> values(n);
+        double sum = compute(values.data(), n);
+        uint64_t count = n;
+        writeAll(fds[1], &count, sizeof(count));
+        writeAll(fds[1], &sum, sizeof(sum));
+        writeAll(fds[1], values.data(), n * sizeof(double));
+        _exit(0);
+    }
+    close(fds[1]);
+    uint64_t count = 0;
+    double sum = 0;
+    vector<double> values;
+    bool ok = readAll(fds[0], &count, sizeof(count)) && readAll(fds[0], &sum, sizeof(sum));
+    if (ok) {
+        values.resize(count);
+        ok = readAll(fds[0], values.data(), count * sizeof(double));
+    }
+    close(fds[0]);
+    if (!ok) {
+        cerr << "socket worker failed" << endl;
+        exit(1);
+    }
+    check(values.data(), count, sum, expected, "socketpair");
+    waitpid(pid, nullptr, 0);
+}
+
+template<typename Round>
+void time(const string& label, Round round, size_t rounds) {
+    auto start = chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        round(r);
+    }
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    cout << label << " took " << elapsed.count() << " ms ("
+         << elapsed.count() / rounds << " ms per handoff)" << endl;
+}
+
+// Opening a segment that is not a promise of the right type, or not one
+// yet, must fail without removing the name its creator still needs
+bool checkOpen() {
+    string name = "/shmPromiseBenchmark." + to_string(getpid()) + ".open";
+    auto promise = ShmPromise<Summary>::create(name);
+    bool refused = false;
+    try {
+        ShmFuture<int>::open(name);
+    } catch (runtime_error&) {
+        refused = true;
+    }
+    auto future = ShmFuture<Summary>::open(name);
+    promise.set_value(Summary{1, 2.0, {}});
+    bool typed = refused && future.get().sum == 2.0;
+
+    // Created by name but never sized or initialized
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        throw system_error{errno, generic_category(), "shm_open " + name};
+    }
+    close(fd);
+    refused = false;
+    try {
+        ShmFuture<Summary>::open(name, chrono::milliseconds(10));
+    } catch (runtime_error&) {
+        refused = true;
+    }
+    bool kept = shm_unlink(name.c_str()) == 0;
+    cout << "mistyped and unready segments refused, names kept: " << boolalpha
+         << (typed && refused && kept) << endl;
+    return typed && refused && kept;
+}
+
+// Handoffs that never open the name must not leave it behind either:
+// get_future() for a forked consumer, and a promise no one opened
+bool checkNamesRemoved() {
+    string name = "/shmPromiseBenchmark." + to_string(getpid()) + ".names";
+    auto exists = [&] {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return fd >= 0;
+    };
+    bool removed;
+    {
+        auto promise = ShmPromise<Summary>::create(name);
+        auto future = promise.get_future();
+        removed = !exists();
+    }
+    {
+        auto promise = ShmPromise<Summary>::create(name);
+    }
+    removed = removed && !exists();
+    cout << "names removed without an open: " << boolalpha << removed << endl;
+    return removed;
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? stoul(argv[1]) : 1000000;
+    size_t rounds = argc > 2 ? stoul(argv[2]) : 20;
+    vector<double> reference(n);
+    double expected = compute(reference.data(), n);
+
+    cout << rounds << " worker processes, each returning " << n << " doubles" << endl;
+    time("ShmPromise + ShmFuture", [&](size_t r) { shmRound(n, r, expected); }, rounds);
+    time("socketpair", [&](size_t) { socketRound(n, expected); }, rounds);
+
+    // A worker that never answers leaves the future waiting, not hung
+    auto promise = ShmPromise<Summary>::create("/shmPromiseBenchmark." + to_string(getpid()) + ".idle");
+    auto future = ShmFuture<Summary>::open("/shmPromiseBenchmark." + to_string(getpid()) + ".idle");
+    cout << "unanswered future ready after 10 ms: " << boolalpha
+         << future.wait_for(chrono::milliseconds(10)) << endl;
+    bool opened = checkOpen();
+    return opened && checkNamesRemoved() ? 0 : 1;
+}
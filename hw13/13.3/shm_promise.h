@@ -0,0 +1,385 @@
+#ifndef SHM_PROMISE_H
+#define SHM_PROMISE_H
+
+#include "my_promoise.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace mpcs {
+
+// A promise/future pair whose shared state lives in a POSIX shared-memory
+// segment instead of on the heap, so the promise and the future can be in
+// different processes. The producer creates the segment by name; the
+// consumer opens the same name (or inherits the mapping across fork and
+// uses get_future()). The name is removed as soon as it has served: by the
+// first ShmFuture::open, by get_future(), or when the promise is
+// destroyed, whichever comes first. A consumer must therefore open the
+// name while the promise exists; the segment itself lives on until every
+// mapping of it is gone.
+//
+//     auto promise = ShmPromise<Stats>::create("/train.stats", 1 << 20);
+//     ShmSpan<double> loads = promise.allocate<double>(cars);
+//     fill(promise.resolve(loads));
+//     promise.set_value(Stats{cars, loads});
+//
+//     auto future = ShmFuture<Stats>::open("/train.stats");
+//     Stats stats = future.get();
+//     std::span<const double> values = future.resolve(stats.loads);
+//
+// Results are never serialized: set_value copies T into the segment and
+// get() copies it out. T and E must therefore be trivially copyable, and a
+// result cannot hold pointers, since the segment is mapped at a different
+// address in every process. Variable-length parts go in the segment's
+// arena instead and are referred to by ShmSpan, which stores an offset.
+// Waiting uses a process-shared futex on the state word.
+
+// n elements of U in a segment's arena, named by their offset from the
+// start of the segment so the handle means the same thing in every process
+template<class U>
+struct ShmSpan {
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+};
+
+namespace shm_detail {
+
+inline void futexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected, const timespec* timeout) {
+    // Not FUTEX_PRIVATE_FLAG: waiter and waker may be different processes
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+inline void futexWakeAll(std::atomic<std::uint32_t>& word) {
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+[[noreturn]] inline void throwErrno(const std::string& what) {
+    throw std::system_error{errno, std::generic_category(), what};
+}
+
+constexpr std::uint64_t alignUp(std::uint64_t n, std::uint64_t align) {
+    return (n + align - 1) / align * align;
+}
+
+enum : std::uint32_t { empty = 0, writing = 1, hasValue = 2, hasError = 3 };
+
+inline constexpr std::uint32_t segmentMagic = 0x53484d50; // "SHMP"
+
+// Start of every segment. Only address-free atomics are used, so the same
+// bytes work at whatever address each process maps them.
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t valueSize;
+    std::uint32_t valueAlign;
+    std::uint32_t errorSize;
+    std::atomic<std::uint32_t> state;   // the futex word
+    std::atomic<std::uint32_t> waiters;
+    std::atomic<std::uint32_t> named;   // 1 until someone claims the unlink
+    std::uint64_t storageOffset;
+    std::uint64_t arenaOffset;
+    std::uint64_t arenaCapacity;
+    std::uint64_t arenaUsed;            // written by the producer only
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "process-shared state needs lock-free 32-bit atomics");
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+              "a futex word is exactly 32 bits");
+
+// Maps a named segment and unmaps it when the last owner goes away. An
+// existing segment smaller than a Header, which its creator has not sized
+// yet, is left unmapped with bytes == 0.
+class Mapping {
+public:
+    Mapping(const std::string& name, std::size_t size, bool create) {
+        int fd = create ? ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600)
+                        : ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            throwErrno("shm_open " + name);
+        }
+        if (create && ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            int err = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::system_error{err, std::generic_category(), "ftruncate " + name};
+        }
+        if (!create) {
+            struct stat info;
+            if (::fstat(fd, &info) != 0) {
+                int err = errno;
+                ::close(fd);
+                throw std::system_error{err, std::generic_category(), "fstat " + name};
+            }
+            size = static_cast<std::size_t>(info.st_size);
+            if (size < sizeof(Header)) {
+                ::close(fd);
+                return;
+            }
+        }
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int err = errno;
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            if (create) {
+                ::shm_unlink(name.c_str());
+            }
+            throw std::system_error{err, std::generic_category(), "mmap " + name};
+        }
+        base = static_cast<std::byte*>(p);
+        bytes = size;
+    }
+
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    ~Mapping() {
+        if (base) {
+            ::munmap(base, bytes);
+        }
+    }
+
+    std::byte* base = nullptr;
+    std::size_t bytes = 0;
+};
+
+} // namespace shm_detail
+
+template<class T, class E = std::errc> class ShmPromise;
+template<class T, class E = std::errc> class ShmFuture;
+
+// What both ends see of a segment
+template<class T, class E>
+class ShmState {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<E>,
+                  "values cross process boundaries as bytes, so T and E must be trivially copyable");
+    static_assert(!std::is_same_v<T, E>, "the error type must differ from the value type");
+
+public:
+    bool is_ready() const {
+        return header().state.load(std::memory_order_acquire) >= shm_detail::hasValue;
+    }
+
+    // The elements a ShmSpan names, in this process's mapping
+    template<class U>
+    std::span<U> resolve(ShmSpan<U> s) const {
+        const shm_detail::Header& h = header();
+        if (s.offset < h.arenaOffset || s.offset + s.size * sizeof(U) > h.arenaOffset + h.arenaCapacity) {
+            throw std::out_of_range{"ShmSpan outside the segment's arena"};
+        }
+        return {std::launder(reinterpret_cast<U*>(mapping->base + s.offset)), static_cast<std::size_t>(s.size)};
+    }
+
+protected:
+    explicit ShmState(std::shared_ptr<shm_detail::Mapping> m) : mapping(std::move(m)) {}
+
+    static constexpr std::uint64_t storageOffset
+        = shm_detail::alignUp(sizeof(shm_detail::Header), std::max({alignof(T), alignof(E), std::size_t(64)}));
+    static constexpr std::uint64_t storageSize = std::max(sizeof(T), sizeof(E));
+
+    shm_detail::Header& header() const { return *std::launder(reinterpret_cast<shm_detail::Header*>(mapping->base)); }
+    std::byte* storage() const { return mapping->base + storageOffset; }
+
+    // Blocks until the result is published, or the timeout passes
+    bool wait(const timespec* timeout = nullptr) const {
+        shm_detail::Header& h = header();
+        for (;;) {
+            std::uint32_t s = h.state.load(std::memory_order_acquire);
+            if (s >= shm_detail::hasValue) {
+                return true;
+            }
+            h.waiters.fetch_add(1, std::memory_order_seq_cst);
+            shm_detail::futexWait(h.state, s, timeout);
+            h.waiters.fetch_sub(1, std::memory_order_seq_cst);
+            if (timeout) {
+                return h.state.load(std::memory_order_acquire) >= shm_detail::hasValue;
+            }
+        }
+    }
+
+    std::shared_ptr<shm_detail::Mapping> mapping;
+};
+
+template<class T, class E>
+class ShmFuture : public ShmState<T, E> {
+public:
+    // Attaches to the segment a ShmPromise created under name, and removes
+    // the name: the segment lives on until both ends have unmapped it. A
+    // segment whose creator has not finished setting it up is waited for,
+    // up to timeout. A segment that holds something else keeps its name.
+    static ShmFuture open(const std::string& name,
+                          std::chrono::milliseconds timeout = std::chrono::seconds(1)) {
+        auto giveUp = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            auto mapping = std::make_shared<shm_detail::Mapping>(name, 0, false);
+            if (mapping->bytes != 0) {
+                auto& h = *std::launder(reinterpret_cast<shm_detail::Header*>(mapping->base));
+                std::uint32_t magic = std::atomic_ref<std::uint32_t>(h.magic).load(std::memory_order_acquire);
+                if (magic != 0) {
+                    if (magic != shm_detail::segmentMagic || h.valueSize != sizeof(T)
+                        || h.valueAlign != alignof(T) || h.errorSize != sizeof(E)
+                        || h.arenaOffset + h.arenaCapacity > mapping->bytes) {
+                        throw std::runtime_error{"ShmFuture: " + name + " does not hold a promise of this type"};
+                    }
+                    if (h.named.exchange(0, std::memory_order_acq_rel)) {
+                        ::shm_unlink(name.c_str());
+                    }
+                    return ShmFuture{std::move(mapping)};
+                }
+            }
+            // Between the creator's shm_open and its store of the magic
+            if (std::chrono::steady_clock::now() >= giveUp) {
+                throw std::runtime_error{"ShmFuture: " + name + " was never set up as a promise"};
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    ShmFuture(const ShmFuture&) = delete;
+    ShmFuture(ShmFuture&&) = default;
+
+    T get() {
+        this->wait();
+        if (this->header().state.load(std::memory_order_acquire) == shm_detail::hasError) {
+            throw FutureError<E>{load<E>()};
+        }
+        return load<T>();
+    }
+
+    expected<T, E> try_get() {
+        this->wait();
+        if (this->header().state.load(std::memory_order_acquire) == shm_detail::hasError) {
+            return unexpected<E>{load<E>()};
+        }
+        return load<T>();
+    }
+
+    // Waits at most timeout; true if the result is ready
+    template<class Rep, class Period>
+    bool wait_for(std::chrono::duration<Rep, Period> timeout) const {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+        timespec relative{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+        return this->wait(&relative);
+    }
+
+private:
+    friend class ShmPromise<T, E>;
+    explicit ShmFuture(std::shared_ptr<shm_detail::Mapping> m) : ShmState<T, E>(std::move(m)) {}
+
+    template<class V>
+    V load() const {
+        V v;
+        std::memcpy(&v, this->storage(), sizeof(V));
+        return v;
+    }
+};
+
+template<class T, class E>
+class ShmPromise : public ShmState<T, E> {
+public:
+    // Creates a segment under name (a POSIX shm name such as "/result.1"),
+    // with arenaBytes of room for variable-length parts of the result.
+    // Fails if the name is taken.
+    static ShmPromise create(const std::string& name, std::size_t arenaBytes = 0) {
+        std::uint64_t arenaOffset = shm_detail::alignUp(ShmPromise::storageOffset + ShmPromise::storageSize, 64);
+        auto mapping = std::make_shared<shm_detail::Mapping>(name, arenaOffset + arenaBytes, true);
+        // The fresh segment is zero-filled; only the fields that are not
+        // zero need writing before anyone can open it by name
+        auto* h = new (mapping->base) shm_detail::Header{};
+        h->valueSize = sizeof(T);
+        h->valueAlign = alignof(T);
+        h->errorSize = sizeof(E);
+        h->storageOffset = ShmPromise::storageOffset;
+        h->arenaOffset = arenaOffset;
+        h->arenaCapacity = arenaBytes;
+        h->named.store(1, std::memory_order_relaxed);
+        std::atomic_ref<std::uint32_t>(h->magic).store(shm_detail::segmentMagic, std::memory_order_release);
+        return ShmPromise{std::move(mapping), name};
+    }
+
+    ShmPromise(const ShmPromise&) = delete;
+    ShmPromise(ShmPromise&&) = default;
+
+    // Removes the name unless a future has already opened it
+    ~ShmPromise() {
+        if (this->mapping) {
+            unlink();
+        }
+    }
+
+    // Room for n elements of U in the arena, to be filled through resolve()
+    // before set_value publishes the result
+    template<class U>
+    ShmSpan<U> allocate(std::size_t n) {
+        static_assert(std::is_trivially_copyable_v<U>, "arena elements cross processes as bytes");
+        shm_detail::Header& h = this->header();
+        std::uint64_t offset = shm_detail::alignUp(h.arenaOffset + h.arenaUsed, alignof(U));
+        if (offset + n * sizeof(U) > h.arenaOffset + h.arenaCapacity) {
+            throw std::bad_alloc{};
+        }
+        h.arenaUsed = offset + n * sizeof(U) - h.arenaOffset;
+        return ShmSpan<U>{offset, n};
+    }
+
+    void set_value(const T& value) { publish(value, shm_detail::hasValue); }
+    void set_error(const E& err) { publish(err, shm_detail::hasError); }
+
+    // A future over the same mapping: for this process, or a child forked
+    // after this call. The name is not needed any more and is removed.
+    ShmFuture<T, E> get_future() {
+        unlink();
+        return ShmFuture<T, E>{this->mapping};
+    }
+
+    // Removes the name now, if no one has yet; the segment stays mapped
+    void unlink() {
+        if (this->header().named.exchange(0, std::memory_order_acq_rel)) {
+            ::shm_unlink(name.c_str());
+        }
+    }
+
+private:
+    ShmPromise(std::shared_ptr<shm_detail::Mapping> m, std::string n)
+        : ShmState<T, E>(std::move(m)), name(std::move(n)) {}
+
+    template<class V>
+    void publish(const V& v, std::uint32_t result) {
+        shm_detail::Header& h = this->header();
+        std::uint32_t expected = shm_detail::empty;
+        if (!h.state.compare_exchange_strong(expected, shm_detail::writing, std::memory_order_acquire)) {
+            throw std::runtime_error{"Promise value already set"};
+        }
+        std::memcpy(this->storage(), &v, sizeof(V));
+        // The release store publishes the value and the arena; seq_cst
+        // pairs with the waiters count so no sleeper is missed
+        h.state.store(result, std::memory_order_seq_cst);
+        if (h.waiters.load(std::memory_order_seq_cst) != 0) {
+            shm_detail::futexWakeAll(h.state);
+        }
+    }
+
+    std::string name;
+};
+
+}
+
+#endif